@@ -5,6 +5,12 @@
  *
  * - arg_desc - description of one argument
  *
+ * - arg_result - values found by parsing. Parser has own result, which is used
+ * by arg_parser_* functions. The parser is not changed by parsing into
+ * separate result, so one parser can be shared between threads, every thread
+ * parses into own result by arg_parser_parse_into and reads values by
+ * arg_result_* functions
+ *
  *
  * Usage:
  *
@@ -15,9 +21,17 @@
  * 3. Call #ARG_PARSER_PARSE for parsing command line argument. Note, check
  * return value for make sure that parsing was successfull, or check err string
  *
- * 4. Use ARG_PARSER_GET_* macroses for getting parsed values
+ * 4. Use ARG_PARSER_GET_* macroses for getting parsed values. Or save handles
+ * returned by ARG_PARSER_ADD_* and use ARG_PARSER_HGET_* macroses, which don't
+ * need lookup by name
  *
  * 5. Call arg_parser_dispose for destroy parser before exit
+ *
+ *
+ * If all flags are known at compile time, then instead of steps 1 and 2 define
+ * read only list of flags by #ARG_PARSER_DEFINE_STATIC and ARG_STATIC_*
+ * macroses and create parser for it by #ARG_PARSER_MAKE_STATIC. The list is
+ * used by parser as is, without copying
  */
 
 #pragma once
@@ -25,16 +39,73 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <float.h>
+#include <limits.h>
+#include <locale.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#  define ARG_PARSER_POSIX
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+// anonymous mappings aren't declared in strict ISO mode without feature test
+// macros, then files are read by stdio
+#  if defined(MAP_ANONYMOUS)
+#    define ARG_PARSER_MMAP MAP_ANONYMOUS
+#  elif defined(MAP_ANON)
+#    define ARG_PARSER_MMAP MAP_ANON
+#  endif
+#endif
+
+// numbers are parsed by 8 digits at once on little endian targets
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || \
+    defined(_M_X64) || defined(_M_IX86) || defined(_M_ARM64)
+#  define ARG_PARSER_SWAR
+#endif
+
+// separators of list values are searched by 16 bytes at once if SSE2 available
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define ARG_PARSER_SSE2
+#  include <emmintrin.h>
+#endif
+
+// fast path for doubles needs operations in double precision
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#  define ARG_PARSER_FAST_FLOAT
+#endif
+
+// arg_parser_parse_many uses threads, define ARG_PARSER_NO_THREADS for
+// parsing in calling thread only
+#if defined(ARG_PARSER_POSIX) && !defined(ARG_PARSER_NO_THREADS)
+#  define ARG_PARSER_THREADS
+#  include <pthread.h>
+#endif
+
 
-#define ARG_MAX_VALUE_LEN   64
 #define ARG_MAX_ERROR_LEN   1024
-#define ARG_MAX_FMT_ARG_LEN 128
+#define ARG_MAX_FILE_DEPTH  16
+#define ARG_MAX_NUM_LEN     (DBL_MAX_10_EXP + 64) // enough for any number
+#define ARG_MANY_CHUNK      64 // count of jobs taken by worker at once
+#define ARG_COMPLETE_FLAG   "--__complete"
+#define ARG_MAX_HINT_LEN    256 // max length of suggestions for unknown flag
+#define ARG_MAX_SUGGESTIONS 3
+#define ARG_LIST_SEP        ',' // separator of values of list args
+
+// roots of trie of names, node 0 means no node
+#define ARG_TRIE_ARGS 1
+#define ARG_TRIE_CMDS 2
+
+#define ARG_ARENA_BLOCK_SIZE 4096
+#define ARG_ARENA_ALIGN      16
+#define ARG_ARENA_ROUND(size) \
+  (((size) + ARG_ARENA_ALIGN - 1) & ~(size_t)(ARG_ARENA_ALIGN - 1))
 
 
 #ifdef __cplusplus
@@ -48,12 +119,32 @@ enum ArgType {
   ArgLong,
   ArgLongLong,
   ArgDouble,
+  // list types take values separated by ARG_LIST_SEP, values of every list
+  // arg are stored as one array of type of value
+  ArgIntList,
+  ArgLongList,
+  ArgLongLongList,
+  ArgDoubleList,
+  ArgStringList,
 };
 enum ArgFlags {
   ArgNone     = 0,
   ArgDefault  = 1 << 0,
   ArgRequired = 1 << 1,
   ArgFound    = 1 << 2,
+  ArgEnv      = 1 << 3, // value can be set by environment variable
+};
+enum ArgParserOptions {
+  ArgParserNone          = 0,
+  ArgParserResponseFiles = 1 << 0, // expand `@path` args to content of file
+  ArgParserEnvAll        = 1 << 1, // all args can be set by environment
+  ArgParserCompletion    = 1 << 2, // answer `--__complete` queries of shell
+  ArgParserAbbrev        = 1 << 3, // accept unique prefixes of long names
+};
+enum ArgShell {
+  ArgShellBash,
+  ArgShellZsh,
+  ArgShellFish,
 };
 
 
@@ -68,37 +159,370 @@ union ArgUnion {
 
 
 typedef struct _arg_desc {
-  char *         name; // argument name (without first --)
-  char *         desc; // description
+  const char *   name; // argument name (without first --)
+  const char *   desc; // description
   union ArgUnion dval; // default value
   enum ArgType   type; // arg type
   int            flgs; // arg flags
   char           shrt; // short name
+  unsigned       nlen; // length of name
 } arg_desc;
 
-typedef struct _arg_rval {
-  char *         name;
-  union ArgUnion rval;
-  enum ArgType   type;
-} arg_rval;
+typedef struct _arg_slot {
+  void *   vals;  // values of one arg, stored as array of the arg type
+  size_t * lens;  // lengths of string values, NULL for other types
+  unsigned count; // count of values
+  unsigned cap;   // capacity of vals
+  bool     seen;  // arg was found, empty list is found without values
+} arg_slot;
+
+
+/**\brief environment variable with prefix, entry of open addressing index
+ */
+typedef struct _arg_env {
+  unsigned    hash; // hash of normalized name without prefix
+  unsigned    nlen; // length of name without prefix, 0 for empty entry
+  const char *name; // full name of variable
+  const char *val;  // value of variable
+} arg_env;
+
+typedef struct _arg_hentry {
+  unsigned hash; // hash of normalized name
+  unsigned aidx; // index in alist (or clist) + 1, 0 for empty entry
+} arg_hentry;
+
+/**\brief node of trie of normalized names, children are sorted by symbol
+ */
+typedef struct _arg_tnode {
+  unsigned child; // first child, 0 if none
+  unsigned next;  // next sibling, 0 if none
+  unsigned aidx;  // index in alist (or clist) + 1 if name ends here, else 0
+  unsigned count; // count of names with prefix of the node
+  char     c;     // symbol of the node
+} arg_tnode;
+
+/**\brief state of search of names similar to unknown flag
+ */
+typedef struct _arg_suggest {
+  const char *name;  // unknown name, not normalized
+  unsigned    len;   // length of unknown name
+  unsigned    dist;  // max edit distance, decreased when closer name found
+  unsigned *  rows;  // rows of edit distance matrix, one per depth in trie
+  unsigned    count; // count of found names
+  unsigned    list[ARG_MAX_SUGGESTIONS]; // indices of found names in alist
+} arg_suggest;
+
+struct _arg_parser;
+
+/**\brief callback which adds args of subcommand to its parser, called only
+ * when the subcommand is chosen
+ */
+typedef void (*arg_cmd_cb)(struct _arg_parser *parser, void *data);
+
+/**\brief description of subcommand, its parser is built lazily
+ */
+typedef struct _arg_cmd {
+  const char *        name;   // normalized name
+  const char *        desc;   // description
+  arg_cmd_cb          build;  // callback which adds args to parser
+  void *              data;   // data for callback
+  struct _arg_parser *parser; // parser of subcommand, NULL until built
+  unsigned            nlen;   // length of name
+} arg_cmd;
+
+
+/**\brief destination of value of arg, which is written after parsing
+ */
+typedef struct _arg_bind {
+  void *dst;    // variable of arg type
+  int   handle; // handle of arg
+} arg_bind;
+
+
+typedef struct _arg_arena_block {
+  struct _arg_arena_block *prev; // previous block
+  size_t                   size; // capacity of the block data
+  size_t                   used; // used bytes of the block data
+} arg_arena_block;
+
+typedef struct _arg_mapping {
+  struct _arg_mapping *prev; // previous mapping
+  void *               addr; // address of mapping
+  size_t               size; // size of mapping
+} arg_mapping;
+
+/**\brief identity of file, same file has same identity for any path to it
+ */
+typedef struct _arg_file_id {
+  uint64_t    dev;  // device of file, 0 if unknown
+  uint64_t    ino;  // inode of file, 0 if unknown
+  const char *path; // path, compared if device and inode are unknown
+} arg_file_id;
+
+/**\brief growing list of args
+ */
+typedef struct _arg_argv {
+  char **  list;
+  unsigned size;
+  unsigned cap;
+} arg_argv;
 
+/**\brief bump allocator, all memory released at once
+ */
+typedef struct _arg_arena {
+  arg_arena_block *head;    // current block, data follows the header
+  void *           last;    // last allocation, can be grown in place
+  unsigned         nallocs; // count of allocations from system
+} arg_arena;
+
+
+typedef struct _arg_result {
+  arg_arena        arena;   // storage of values, expanded argv and arg copies
+  arg_slot *       slist;   // values, same index as in alist of parser
+  unsigned         scap;    // capacity of slist
+  arg_mapping *    mlist;   // memory mapped files, unmapped by reset
+  arg_arena_block *mblock;  // block of arena at end of slots, NULL if not set
+  size_t           mused;   // used bytes of mblock at end of slots
+  int              pending; // arg waiting for value in feed mode, -1 if none
+  const char *     pflag;   // flag of pending arg
+  int              code;    // code returned by parsing in arg_parser_parse_many
+  const char *     err;     // error of parsing in arg_parser_parse_many or NULL
+  int              cmd;     // index of subcommand found by parsing, -1 if none
+  int              cpos;    // index of subcommand in argv after parsing
+} arg_result;
 
 typedef struct _arg_parser {
-  char *    mdesc; // main description
-  arg_desc *alist; // list of described args
-  arg_rval *rlist; // list with return values
-  unsigned  asize; // count of described args
-  unsigned  rsize; // count of return values
+  arg_arena   arena;       // storage for all memory owned by parser
+  const char *mdesc;       // main description
+  arg_desc *  alist;       // list of described args
+  unsigned    asize;       // count of described args
+  unsigned    acap;        // capacity of alist
+  arg_hentry *htable;      // open addressing index of long names
+  unsigned    hcap;        // capacity of htable, power of two
+  unsigned    stable[256]; // index in alist + 1 by short name, 0 if not set
+  int         opts;        // parser options @see ArgParserOptions
+  arg_result  res;         // result of arg_parser_parse and arg_parser_feed
+  unsigned    ucol;        // width of column with flags in usage
+  const char *usage;       // cached usage, NULL if schema was changed
+  size_t      ulen;        // length of cached usage
+  arg_env *   etable;      // index of environment variables with prefix
+  unsigned    ecap;        // capacity of etable, power of two
+  unsigned    eplen;       // length of prefix of environment variables
+  arg_result  fres;        // values loaded from config files
+  arg_cmd *   clist;       // list of subcommands
+  unsigned    csize;       // count of subcommands
+  unsigned    ccap;        // capacity of clist
+  arg_hentry *ctable;      // open addressing index of subcommands
+  unsigned    ctcap;       // capacity of ctable, power of two
+  arg_tnode * tlist;       // trie of names of args and subcommands
+  unsigned    tsize;       // count of nodes in tlist
+  unsigned    tcap;        // capacity of tlist
+  arg_bind *  blist;       // variables bound to args
+  unsigned    bsize;       // count of bound variables
+  unsigned    bcap;        // capacity of blist
 } arg_parser;
 
 
+/**\brief callback for arg_parser_usage_write, receives usage by chunks
+ * \return 0 for continue, otherwise writing stops
+ */
+typedef int (*arg_usage_cb)(void *data, const char *str, size_t len);
+
+/**\brief destination of rendered usage: callback or buffer
+ */
+typedef struct _arg_sink {
+  arg_usage_cb cb;     // callback or NULL if writing to buffer
+  void *       data;   // data for callback
+  char *       buf;    // buffer, could be NULL
+  size_t       size;   // size of buffer
+  size_t       len;    // count of rendered symbols
+  int          status; // value returned by callback
+} arg_sink;
+
+
+/**\brief range of jobs of one worker of arg_parser_parse_many, other workers
+ * steal from its end
+ */
+typedef struct _arg_worker {
+  struct _arg_pool *pool;  // pool of the worker
+  int               begin; // first job not taken yet
+  int               end;   // end of jobs of the worker
+#ifdef ARG_PARSER_THREADS
+  pthread_mutex_t lock; // guards begin and end
+  pthread_t       thread;
+#endif
+} arg_worker;
+
+typedef struct _arg_pool {
+  const arg_parser *parser;
+  const int *       argcs;
+  char **const *    argvs;
+  arg_result *      results;
+  arg_worker *      workers;
+  int               size; // count of workers
+} arg_pool;
+
+
 enum ArgType typename2argtype(const char *type_name);
 char *       val_to_string(union ArgUnion val, enum ArgType type);
+unsigned     arg_type_size(enum ArgType type);
+enum ArgType arg_list_elem(enum ArgType type);
+int          arg_val_from_range(enum ArgType    type,
+                                const char *    str,
+                                const char *    end,
+                                union ArgUnion *val);
+int          arg_val_from_str(enum ArgType    type,
+                              const char *    str,
+                              union ArgUnion *val);
+int          arg_is_space(char c);
+unsigned     arg_digit(char c);
+int          arg_swar_is_digits(uint64_t chunk);
+uint32_t     arg_swar_digits(uint64_t chunk);
+int          arg_parse_ll(const char *str,
+                          const char *end,
+                          long long   min,
+                          long long   max,
+                          long long * val);
+int          arg_parse_double(const char *str, const char *end, double *val);
+int          arg_strtod(const char *str,
+                        const char *end,
+                        const char *point,
+                        double *    val);
+unsigned     arg_ctz(uint64_t val);
+unsigned     arg_popcount(uint64_t val);
+uint64_t     arg_swar_eq(uint64_t chunk, char c);
+const char * arg_find_sep(const char *str, const char *end);
+unsigned     arg_count_sep(const char *str, const char *end);
 char *       str_to_arg_name(const char *name);
 int          str_arg_cmp(const char *lhs, const char *rhs);
 int          arg_name_cmp(const char *arg_name,
                           char        short_name,
                           const char *val_for_comp);
+char         arg_name_char(char c);
+unsigned     arg_name_hash(const char *name, unsigned len);
+int          arg_name_eq(const char *arg_name, const char *name, unsigned len);
+
+void  arg_arena_add_block(arg_arena *arena, size_t size);
+void  arg_arena_reserve(arg_arena *arena, size_t size);
+void *arg_arena_alloc(arg_arena *arena, size_t size);
+void *arg_arena_grow(arg_arena *arena, void *ptr, size_t size, size_t new_size);
+char *arg_arena_strdup(arg_arena *arena, const char *str);
+void  arg_arena_rewind(arg_arena *arena, arg_arena_block *block, size_t used);
+void  arg_arena_release(arg_arena *arena);
+
+char *arg_result_map_file(arg_result * res,
+                          const char * path,
+                          size_t *     size,
+                          arg_file_id *id);
+int   arg_file_same(const arg_file_id *lhs, const arg_file_id *rhs);
+char *arg_next_token(char **iter, char *end);
+void  arg_argv_push(arg_arena *arena, arg_argv *args, char *arg);
+const char *arg_result_expand_arg(arg_result * res,
+                                  arg_argv *   args,
+                                  char *       arg,
+                                  int          depth,
+                                  arg_file_id *chain,
+                                  bool *       cycle);
+const char *
+arg_result_expand(arg_result *res, int *argc, char **argv[], bool *cycle);
+
+unsigned arg_format_val(union ArgUnion val,
+                        enum ArgType   type,
+                        char *         buf,
+                        const char **  str);
+unsigned arg_usage_width(const arg_desc *arg);
+void     arg_sink_put(arg_sink *sink, const char *str, size_t len);
+void     arg_sink_pad(arg_sink *sink, size_t count);
+void     arg_parser_render_usage(const arg_parser *parser, arg_sink *sink);
+int      arg_file_cb(void *file, const char *str, size_t len);
+
+void arg_parser_index_arg(arg_parser *parser, unsigned arg_iter);
+int  arg_parser_find(const arg_parser *parser, const char *name, unsigned len);
+void arg_parser_index_cmd(arg_parser *parser, unsigned cmd_iter);
+int  arg_parser_find_cmd(const arg_parser *parser, const char *name);
+unsigned arg_trie_child(const arg_parser *parser, unsigned node, char c);
+void     arg_trie_insert(arg_parser *parser,
+                         unsigned    root,
+                         const char *name,
+                         unsigned    len,
+                         unsigned    idx);
+unsigned arg_trie_find(const arg_parser *parser,
+                       unsigned          root,
+                       const char *      prefix,
+                       unsigned          len);
+int      arg_trie_print(const arg_parser *parser,
+                        unsigned          root,
+                        unsigned          node,
+                        FILE *            out);
+int  arg_parser_find_prefix(const arg_parser *parser,
+                            const char *      name,
+                            unsigned          len);
+void arg_trie_collect(const arg_parser *parser,
+                      unsigned          node,
+                      arg_suggest *     state);
+void arg_trie_suggest(const arg_parser *parser,
+                      unsigned          node,
+                      unsigned          depth,
+                      arg_suggest *     state);
+unsigned arg_parser_suggest(const arg_parser *parser,
+                            const char *      flag,
+                            char *            buf,
+                            unsigned          size);
+void     arg_script_name(const char *prog, FILE *out);
+int  arg_parser_match(const arg_parser *parser,
+                      const char *      flag,
+                      const char **     val,
+                      unsigned *        bools);
+void arg_result_store_bools(const arg_parser *parser,
+                            arg_result *      res,
+                            const char *      flag,
+                            unsigned          bools);
+void arg_result_fit(const arg_parser *parser, arg_result *res);
+void arg_result_reserve(const arg_parser *parser,
+                        arg_result *      res,
+                        int               handle,
+                        unsigned          count);
+int  arg_result_store_list(const arg_parser *parser,
+                           arg_result *      res,
+                           int               handle,
+                           const char *      str);
+void arg_result_push_len(const arg_parser *parser,
+                         arg_result *      res,
+                         int               handle,
+                         union ArgUnion    val,
+                         size_t            len);
+void arg_result_push_val(const arg_parser *parser,
+                         arg_result *      res,
+                         int               handle,
+                         union ArgUnion    val);
+int  arg_result_store(const arg_parser *parser,
+                      arg_result *      res,
+                      int               handle,
+                      const char *      str);
+int  arg_result_finalize(const arg_parser *parser,
+                         arg_result *      res,
+                         char **           err);
+const arg_env *arg_parser_find_env(const arg_parser *parser,
+                                   const arg_desc *  arg);
+char *arg_next_line(char **iter, char *end, char **val);
+void  arg_result_restore_slots(arg_result *res, const arg_slot *saved);
+const arg_slot *
+arg_result_slot(const arg_parser *parser, const arg_result *res, int handle);
+
+int arg_parser_parse_args(const arg_parser *parser,
+                          arg_result *      res,
+                          int *             argc,
+                          char **           argv[],
+                          bool              ignore_not_defined_flags,
+                          bool              remove_defined_flags_from_argv,
+                          int *             kept,
+                          int               kept_size,
+                          int *             kept_count,
+                          char **           err);
+
+int   arg_pool_take(arg_worker *worker, int *begin, int *end);
+int   arg_pool_steal(arg_worker *worker);
+void *arg_pool_run(void *worker);
 
 union ArgUnion arg_union_make_from_str(const char *val);
 union ArgUnion arg_union_make_from_bool(bool val);
@@ -120,27 +544,189 @@ void *void_ptr_cast_from_double(double *val);
  */
 arg_parser *arg_parser_make(const char *main_desc);
 
+/**\brief create instance of arg_parser for read only list of args
+ * \param list list of args with normalized names, @see ARG_PARSER_DEFINE_STATIC
+ * \param size count of args in the list
+ * \note the list is not copied, so it must exist while parser exists
+ */
+arg_parser *arg_parser_make_static(const char *    main_desc,
+                                   const arg_desc *list,
+                                   unsigned        size);
+
 /**\brief destroy instance of arg_parser
  */
 void arg_parser_dispose(arg_parser *parser);
 
+/**\return count of memory allocations from system made by parser
+ */
+unsigned arg_parser_alloc_count(const arg_parser *parser);
+
+/**\brief set parser options
+ * \param opts combination of ArgParserOptions
+ */
+void arg_parser_set_opts(arg_parser *parser, int opts);
+
+/**\brief index environment variables with given prefix, so args with ArgEnv
+ * flag (or all args if ArgParserEnvAll option set) without values in argv
+ * take values from variables `<prefix><NAME>`, where NAME is name of arg in
+ * upper case with `_` instead of `-`. Values are converted and checked as
+ * values from argv, default values are used only if there is no variable
+ * \param envp list of variables `NAME=value` ended by NULL, if NULL, then
+ * environment of process is used
+ * \note variables are copied to parser, so changes of environment after the
+ * call are not visible for parser until next call
+ */
+void arg_parser_set_env(arg_parser *parser, const char *prefix, char **envp);
+
+/**\brief load values of args from config file with lines `key = value`.
+ * Keys are names of args in any case and with `_` or `-`, lines started by
+ * `#` are comments, value is rest of line without spaces around it and
+ * optional quotes. Line with only key sets bool arg to true
+ * \return 0 in case of success, otherwise same error codes as
+ * arg_parser_parse returns
+ * \note values are used for args without values in argv and environment,
+ * before default values. File is memory mapped and split in place, so string
+ * values point to the mapping, which exists while parser exists. Values of
+ * several loaded files are accumulated
+ */
+int arg_parser_load_file(arg_parser *parser, const char *path, char **err);
+
 /**\return description of flags
  * \note you should free returned string after usage
  */
 char *arg_parser_usage(arg_parser *parser);
 
-void arg_parser_add_arg(arg_parser *   parser,
-                        const char *   name,
-                        char           short_name,
-                        const char *   desc,
-                        enum ArgType   type,
-                        int            flags,
-                        union ArgUnion default_val);
+/**\return usage owned by parser, which is rendered only once and valid until
+ * schema of parser changes
+ */
+const char *arg_parser_usage_cached(arg_parser *parser);
+
+/**\brief render usage to buffer, same as snprintf: result is truncated to
+ * size - 1 symbols and always terminated by `\0` if size is not 0
+ * \return length of whole usage
+ */
+size_t arg_parser_usage_to(const arg_parser *parser, char *buf, size_t size);
+
+/**\brief render usage by chunks passed to callback
+ * \return 0 in case of success, otherwise value returned by callback
+ */
+int arg_parser_usage_write(const arg_parser *parser,
+                           arg_usage_cb      callback,
+                           void *            data);
+
+/**\brief write usage to file
+ * \return 0 in case of success, otherwise non zero value
+ */
+int arg_parser_usage_print(const arg_parser *parser, FILE *file);
+
+/**\return handle of added arg, which is stable while parser exists
+ */
+int arg_parser_add_arg(arg_parser *   parser,
+                       const char *   name,
+                       char           short_name,
+                       const char *   desc,
+                       enum ArgType   type,
+                       int            flags,
+                       union ArgUnion default_val);
+
+/**\brief bind variable to arg, last value of the arg (or default value) is
+ * written to the variable by successfull arg_parser_parse or
+ * arg_parser_finish, so values don't need to be got after parsing. If the arg
+ * has no values, then the variable isn't changed
+ * \param dst pointer to variable of arg type: bool, const char *, int, long,
+ * long long or double
+ * \return 0 in case of success, -1 if handle is not valid, arg is list or dst
+ * is NULL
+ * \note binding of same arg again replaces its variable
+ */
+int arg_parser_bind(arg_parser *parser, int handle, void *dst);
+
+/**\brief same as arg_parser_add_arg, but variable is bound to added arg
+ * \return handle of added arg, -1 if dst is NULL, type is list or arg can't
+ * be added
+ * \see ARG_PARSER_BIND_ARG
+ */
+int arg_parser_add_bound(arg_parser *   parser,
+                         const char *   name,
+                         char           short_name,
+                         const char *   desc,
+                         enum ArgType   type,
+                         int            flags,
+                         union ArgUnion default_val,
+                         void *         dst);
+
+/**\brief write last values from result to variables bound to args
+ * \note called by arg_parser_parse for its result, other results are written
+ * only by this call
+ */
+void arg_result_write_bound(const arg_parser *parser, const arg_result *res);
+
+/**\brief add subcommand, which is chosen by first positional arg equal to its
+ * name. Parsing stops at the subcommand and arg_parser_parse passes rest of
+ * argv (started by the subcommand as program name) to parser of the
+ * subcommand, which is built by the callback only when the subcommand is
+ * chosen
+ * \param build callback which adds args to parser of the subcommand
+ * \return handle of added subcommand
+ * \note parser of subcommand has options of parent except response files,
+ * which are already expanded by parent
+ */
+int arg_parser_add_cmd(arg_parser *parser,
+                       const char *name,
+                       const char *desc,
+                       arg_cmd_cb  build,
+                       void *      data);
+
+/**\return parser of subcommand with given handle, which is built at first
+ * call, or NULL if handle is not valid
+ */
+arg_parser *arg_parser_cmd_parser(arg_parser *parser, int cmd);
+
+/**\return handle of subcommand found by last arg_parser_parse or -1
+ */
+int arg_parser_cmd(const arg_parser *parser);
+
+/**\return handle of subcommand found by parsing into result or -1
+ * \param pos if not NULL, then set to index of subcommand in argv after
+ * parsing, args started from it are not parsed
+ */
+int arg_result_cmd(const arg_result *res, int *pos);
+
+/**\brief print to out names of flags or subcommands, which complete word
+ * with given index, one name per line. Names are taken from trie, so query
+ * doesn't parse words and doesn't compare all names
+ * \param words words of command line, first one is program name
+ * \return count of printed names, 0 if nothing to complete or value of flag
+ * is expected
+ * \note if ArgParserCompletion option set, then arg_parser_parse answers
+ * queries `program --__complete <index> <words...>` by this function to
+ * stdout and returns 6
+ */
+int arg_parser_complete(arg_parser *parser,
+                        int         index,
+                        int         count,
+                        char *      words[],
+                        FILE *      out);
+
+/**\brief write to out completion script for shell, which calls
+ * `prog --__complete` for every completion
+ * \param prog name of program command
+ * \return 0 in case of success, otherwise non zero value
+ */
+int arg_complete_script(const char *prog, enum ArgShell shell, FILE *out);
+
+/**\return handle of arg with given name or -1 if the arg is not defined
+ */
+int arg_parser_handle(const arg_parser *parser, const char *name);
 
 /**\return count of arg values with given name
  */
 int arg_parser_count(arg_parser *parser, const char *name);
 
+/**\return count of arg values with given handle
+ */
+int arg_parser_hcount(const arg_parser *parser, int handle);
+
 /**\return capacity of returned values
  * \param count desired count of values for return associated with given flag
  * \note val should be a pointer with allocated space not less then count
@@ -151,6 +737,82 @@ int arg_parser_get_args(const arg_parser *parser,
                         void *            val,
                         int               count);
 
+/**\brief same as arg_parser_get_args, but for arg with given handle
+ * \return count of returned values or -1 if type is not same as type of arg
+ */
+int arg_parser_hget_args(const arg_parser *parser,
+                         int               handle,
+                         enum ArgType      type,
+                         void *            val,
+                         int               count);
+
+/**\brief return last value of arg with given handle
+ * \return 1 in case of success, 0 if arg has no values, -1 if type is not
+ * same as type of arg
+ */
+int arg_parser_hget_last(const arg_parser *parser,
+                         int               handle,
+                         enum ArgType      type,
+                         void *            val);
+
+/**\brief get all values of arg with given handle without copying, values of
+ * list args and repeated flags are stored as one array of type of value
+ * \param len set to count of values
+ * \return pointer to values, valid until next parsing, or NULL if arg has no
+ * values or type is not same as type of arg
+ */
+const void *arg_parser_hget_list(const arg_parser *parser,
+                                 int               handle,
+                                 enum ArgType      type,
+                                 unsigned *        len);
+
+/**\brief get string value with given index and its length, which is found
+ * by parsing, so value doesn't need strlen
+ * \param index index of value, values of list args are counted separately
+ * \return 1 in case of success, 0 if arg has no value with the index, -1 if
+ * arg is not string or string list
+ */
+int arg_parser_hget_strn(const arg_parser *parser,
+                         int               handle,
+                         unsigned          index,
+                         const char **     str,
+                         size_t *          len);
+
+/**\brief drop all values found by previous parsing, so parser can be used
+ * for next command line. Storage for values is kept, so next parsing with
+ * same or smaller count of values doesn't allocate memory
+ * \note arg_parser_parse calls it automatically
+ * \note values, copies of list strings, argv expanded from response files and
+ * the files mapped by previous parsing are released, so pointers got from it
+ * become invalid
+ */
+void arg_parser_reset(arg_parser *parser);
+
+/**\brief callback for arg_parser_parse_batch, values of parsed command line
+ * are available by parser only inside the callback
+ * \param index index of command line in the batch
+ * \param result result of arg_parser_parse for the command line
+ * \return 0 for continue parsing, otherwise batch parsing stops
+ */
+typedef int (*arg_parser_batch_cb)(arg_parser *parser,
+                                   int         index,
+                                   int         result,
+                                   void *      data);
+
+/**\brief parse `count` command lines one by one, reusing storage for values
+ * \param argcs list of argc for every command line
+ * \param argvs list of argv for every command line, not modified
+ * \return 0 if all command lines were passed to callback, otherwise value
+ * returned by callback
+ */
+int arg_parser_parse_batch(arg_parser *        parser,
+                           int                 count,
+                           const int *         argcs,
+                           char **const *      argvs,
+                           bool                ignore_not_defined_flags,
+                           arg_parser_batch_cb callback,
+                           void *              data);
+
 /**\brief parse args by parser
  * \return 0 if parsing was successfull, otherwise return not 0 value
  * \param ignore_not_defined_flags if false, then parsing fail if unknown flag
@@ -159,6 +821,17 @@ int arg_parser_get_args(const arg_parser *parser,
  * program name, positional arguments and not defined flags
  * \param err if non NULL, then parser store string with error if parsing
  * failed. NOTE: you should call free for the string after using
+ * \note if ArgParserResponseFiles option set and argv has `@path` args, then
+ * argv will point to list owned by parser, where the args replaced by content
+ * of files. The files are memory mapped and splitted to args in place (by
+ * spaces, with quotes and `\` escapes), so values point to the mappings
+ * \note values, expanded argv and strings of the mappings are valid only until
+ * next parsing or reset of the parser (or the result for parsing into result)
+ * \note if ArgParserCompletion option set and argv is completion query, then
+ * the query is answered to stdout and 6 returned, @see arg_parser_complete
+ * \note if subcommand found, then rest of argv is parsed by its parser, @see
+ * arg_parser_add_cmd. If remove_defined_flags_from_argv set, then argv has
+ * kept args of parent, the subcommand and kept args of subcommand
  */
 int arg_parser_parse(arg_parser *parser,
                      int *       argc,
@@ -190,6 +863,172 @@ int arg_parser_parse(arg_parser *parser,
                    err)
 
 
+/**\brief parse one arg, args passed in same order as in argv without program
+ * name. Value of flag can be passed by next call. Call arg_parser_finish after
+ * last arg
+ * \return 0 in case of success, otherwise same error codes as
+ * arg_parser_parse returns
+ * \note string values are copied, so arg may be freed after the call
+ */
+int arg_parser_feed(arg_parser *parser,
+                    const char *arg,
+                    bool        ignore_not_defined_flags,
+                    char **     err);
+
+/**\brief finish parsing of args passed by arg_parser_feed: check pending flag
+ * and required flags, add default values
+ * \return 0 in case of success, otherwise same error codes as
+ * arg_parser_parse returns
+ */
+int arg_parser_finish(arg_parser *parser, char **err);
+
+
+/**\brief create empty result for arg_parser_parse_into
+ * \note result can be reused for many parsings by parser, which was used for
+ * the first parsing into it
+ */
+arg_result *arg_result_make(void);
+
+/**\brief init result placed in memory of caller, for example in array of
+ * results for arg_parser_parse_many. Memory is not allocated until parsing
+ */
+void arg_result_init(arg_result *res);
+
+/**\brief release memory of result initialized by arg_result_init
+ */
+void arg_result_release(arg_result *res);
+
+/**\brief destroy instance of arg_result, values and argv expanded by parsing
+ * into the result become invalid
+ */
+void arg_result_dispose(arg_result *res);
+
+/**\brief same as arg_parser_reset, but for given result, pointers got from
+ * the result become invalid
+ */
+void arg_result_reset(const arg_parser *parser, arg_result *res);
+
+/**\brief same as arg_parser_parse, but values stored to given result
+ * \note parser is not changed, so several threads can parse by one parser at
+ * the same time, if every thread has own result. Parsing stops at
+ * subcommand, but rest of argv is not parsed, @see arg_result_cmd
+ */
+int arg_parser_parse_into(const arg_parser *parser,
+                          arg_result *      res,
+                          int *             argc,
+                          char **           argv[],
+                          bool              ignore_not_defined_flags,
+                          bool              remove_defined_flags_from_argv,
+                          char **           err);
+
+/**\brief same as arg_parser_parse_into, but instead of removing flags from
+ * argv, indices of args which would stay in argv (program name and
+ * positional args) are written to kept
+ * \param kept list with space for kept_size indices
+ * \param kept_count set to count of kept args, if it is greater than
+ * kept_size, then only first kept_size indices are written
+ * \note if ArgParserResponseFiles set, then argc and argv are set to expanded
+ * args, which can be more than args passed, and indices refer to the expanded
+ * argv
+ */
+int arg_parser_parse_kept(const arg_parser *parser,
+                          arg_result *      res,
+                          int *             argc,
+                          char **           argv[],
+                          bool              ignore_not_defined_flags,
+                          int *             kept,
+                          int               kept_size,
+                          int *             kept_count,
+                          char **           err);
+
+/**\brief same as arg_parser_feed, but values stored to given result
+ */
+int arg_parser_feed_into(const arg_parser *parser,
+                         arg_result *      res,
+                         const char *      arg,
+                         bool              ignore_not_defined_flags,
+                         char **           err);
+
+/**\brief same as arg_parser_finish, but for given result
+ */
+int arg_parser_finish_into(const arg_parser *parser,
+                           arg_result *      res,
+                           char **           err);
+
+/**\brief parse `count` command lines in several threads with work stealing
+ * \param argcs list of argc for every command line
+ * \param argvs list of argv for every command line, not modified
+ * \param results list of `count` results initialized by arg_result_init, code
+ * of parsing and error are stored to `code` and `err` of every result
+ * \param nthreads count of threads including calling one, if less then 1, then
+ * count of online processors
+ * \return count of command lines parsed with error
+ * \note if ARG_PARSER_NO_THREADS defined, then all command lines are parsed
+ * in calling thread
+ */
+int arg_parser_parse_many(const arg_parser *parser,
+                          int               count,
+                          const int *       argcs,
+                          char **const *    argvs,
+                          arg_result *      results,
+                          int               nthreads);
+
+/**\return count of values of arg with given name in result
+ */
+int arg_result_count(const arg_parser *parser,
+                     const arg_result *res,
+                     const char *      name);
+
+/**\return count of values of arg with given handle in result
+ */
+int arg_result_hcount(const arg_parser *parser,
+                      const arg_result *res,
+                      int               handle);
+
+/**\brief same as arg_parser_get_args, but values taken from given result
+ */
+int arg_result_get_args(const arg_parser *parser,
+                        const arg_result *res,
+                        const char *      name,
+                        enum ArgType      type,
+                        void *            val,
+                        int               count);
+
+/**\brief same as arg_parser_hget_args, but values taken from given result
+ */
+int arg_result_hget_args(const arg_parser *parser,
+                         const arg_result *res,
+                         int               handle,
+                         enum ArgType      type,
+                         void *            val,
+                         int               count);
+
+/**\brief same as arg_parser_hget_last, but value taken from given result
+ */
+int arg_result_hget_last(const arg_parser *parser,
+                         const arg_result *res,
+                         int               handle,
+                         enum ArgType      type,
+                         void *            val);
+
+/**\brief same as arg_parser_hget_list, but values taken from given result
+ */
+const void *arg_result_hget_list(const arg_parser *parser,
+                                 const arg_result *res,
+                                 int               handle,
+                                 enum ArgType      type,
+                                 unsigned *        len);
+
+/**\brief same as arg_parser_hget_strn, but value taken from given result
+ */
+int arg_result_hget_strn(const arg_parser *parser,
+                         const arg_result *res,
+                         int               handle,
+                         unsigned          index,
+                         const char **     str,
+                         size_t *          len);
+
+
 /**\brief add argument description to parser
  * \param parser arg_parser object
  * \param key name of argument
@@ -197,7 +1036,7 @@ int arg_parser_parse(arg_parser *parser,
  * \param type type of argument
  * \param default_val default value for argument
  * \param flags argument flags @see ArgFlags
- * \return 0 if case of success, otherwise non zero value
+ * \return handle of the argument, @see ARG_PARSER_HGET_ARG
  */
 #define ARG_PARSER_ADD_ARG(parser,            \
                            key,               \
@@ -340,6 +1179,423 @@ int arg_parser_parse(arg_parser *parser,
                      default_val,         \
                      ArgDefault)
 
+/**\brief add argument and bind variable to it, last value of the argument
+ * (or default value) is written to the variable by arg_parser_parse
+ * \param dst pointer to variable of argument type
+ * \return handle of the argument
+ * \see arg_parser_bind
+ */
+#define ARG_PARSER_BIND_ARG(parser,                             \
+                            key,                                \
+                            short_name,                         \
+                            description,                        \
+                            type,                               \
+                            default_val,                        \
+                            flags,                              \
+                            dst)                                \
+  arg_parser_add_bound(parser,                                  \
+                       key,                                     \
+                       short_name,                              \
+                       description,                             \
+                       typename2argtype(#type),                 \
+                       flags,                                   \
+                       arg_union_make_from_##type(default_val), \
+                       void_ptr_cast_from_##type(dst))
+
+
+#define ARG_PARSER_BIND_STR(parser, key, short_name, description, dst) \
+  ARG_PARSER_BIND_ARG(parser,                                          \
+                      key,                                             \
+                      short_name,                                      \
+                      description,                                     \
+                      str,                                             \
+                      NULL,                                            \
+                      0,                                               \
+                      dst)
+
+#define ARG_PARSER_BIND_INT(parser, key, short_name, description, dst) \
+  ARG_PARSER_BIND_ARG(parser,                                          \
+                      key,                                             \
+                      short_name,                                      \
+                      description,                                     \
+                      int,                                             \
+                      0,                                               \
+                      0,                                               \
+                      dst)
+
+#define ARG_PARSER_BIND_LONG(parser, key, short_name, description, dst) \
+  ARG_PARSER_BIND_ARG(parser,                                           \
+                      key,                                              \
+                      short_name,                                       \
+                      description,                                      \
+                      long,                                             \
+                      0,                                                \
+                      0,                                                \
+                      dst)
+
+#define ARG_PARSER_BIND_LL(parser, key, short_name, description, dst) \
+  ARG_PARSER_BIND_ARG(parser,                                         \
+                      key,                                            \
+                      short_name,                                     \
+                      description,                                    \
+                      ll,                                             \
+                      0,                                              \
+                      0,                                              \
+                      dst)
+
+#define ARG_PARSER_BIND_DOUBLE(parser, key, short_name, description, dst) \
+  ARG_PARSER_BIND_ARG(parser,                                             \
+                      key,                                                \
+                      short_name,                                         \
+                      description,                                        \
+                      double,                                             \
+                      0,                                                  \
+                      0,                                                  \
+                      dst)
+
+#define ARG_PARSER_BIND_BOOL(parser, key, short_name, description, dst) \
+  ARG_PARSER_BIND_ARG(parser,                                           \
+                      key,                                              \
+                      short_name,                                       \
+                      description,                                      \
+                      bool,                                             \
+                      false,                                            \
+                      0,                                                \
+                      dst)
+
+/**\brief same as ARG_PARSER_ADD_*D with dst appended last, so the default
+ * is in the same position for both families
+ */
+#define ARG_PARSER_BIND_STRD(parser,      \
+                             key,         \
+                             short_name,  \
+                             description, \
+                             default_val, \
+                             dst)         \
+  ARG_PARSER_BIND_ARG(parser,             \
+                      key,                \
+                      short_name,         \
+                      description,        \
+                      str,                \
+                      default_val,        \
+                      ArgDefault,         \
+                      dst)
+
+#define ARG_PARSER_BIND_INTD(parser,      \
+                             key,         \
+                             short_name,  \
+                             description, \
+                             default_val, \
+                             dst)         \
+  ARG_PARSER_BIND_ARG(parser,             \
+                      key,                \
+                      short_name,         \
+                      description,        \
+                      int,                \
+                      default_val,        \
+                      ArgDefault,         \
+                      dst)
+
+#define ARG_PARSER_BIND_LONGD(parser,      \
+                              key,         \
+                              short_name,  \
+                              description, \
+                              default_val, \
+                              dst)         \
+  ARG_PARSER_BIND_ARG(parser,              \
+                      key,                 \
+                      short_name,          \
+                      description,         \
+                      long,                \
+                      default_val,         \
+                      ArgDefault,          \
+                      dst)
+
+#define ARG_PARSER_BIND_LLD(parser,      \
+                            key,         \
+                            short_name,  \
+                            description, \
+                            default_val, \
+                            dst)         \
+  ARG_PARSER_BIND_ARG(parser,            \
+                      key,               \
+                      short_name,        \
+                      description,       \
+                      ll,                \
+                      default_val,       \
+                      ArgDefault,        \
+                      dst)
+
+#define ARG_PARSER_BIND_DOUBLED(parser,      \
+                                key,         \
+                                short_name,  \
+                                description, \
+                                default_val, \
+                                dst)         \
+  ARG_PARSER_BIND_ARG(parser,                \
+                      key,                   \
+                      short_name,            \
+                      description,           \
+                      double,                \
+                      default_val,           \
+                      ArgDefault,            \
+                      dst)
+
+#define ARG_PARSER_BIND_BOOLD(parser,      \
+                              key,         \
+                              short_name,  \
+                              description, \
+                              default_val, \
+                              dst)         \
+  ARG_PARSER_BIND_ARG(parser,              \
+                      key,                 \
+                      short_name,          \
+                      description,         \
+                      bool,                \
+                      default_val,         \
+                      ArgDefault,          \
+                      dst)
+
+/**\brief add list argument, which takes values separated by ARG_LIST_SEP
+ * \param type one of list types @see ArgType
+ * \param default_val string with default values or NULL
+ */
+#define ARG_PARSER_ADD_LIST(parser,      \
+                            key,         \
+                            short_name,  \
+                            description, \
+                            type,        \
+                            default_val, \
+                            flags)       \
+  arg_parser_add_arg(parser,             \
+                     key,                \
+                     short_name,         \
+                     description,        \
+                     type,               \
+                     flags,              \
+                     arg_union_make_from_str(default_val))
+
+#define ARG_PARSER_ADD_INT_LIST(parser,      \
+                                key,         \
+                                short_name,  \
+                                description, \
+                                is_required) \
+  ARG_PARSER_ADD_LIST(parser,                \
+                      key,                   \
+                      short_name,            \
+                      description,           \
+                      ArgIntList,            \
+                      NULL,                  \
+                      (is_required) ? ArgRequired : 0)
+
+#define ARG_PARSER_ADD_LONG_LIST(parser,      \
+                                 key,         \
+                                 short_name,  \
+                                 description, \
+                                 is_required) \
+  ARG_PARSER_ADD_LIST(parser,                 \
+                      key,                    \
+                      short_name,             \
+                      description,            \
+                      ArgLongList,            \
+                      NULL,                   \
+                      (is_required) ? ArgRequired : 0)
+
+#define ARG_PARSER_ADD_LL_LIST(parser,      \
+                               key,         \
+                               short_name,  \
+                               description, \
+                               is_required) \
+  ARG_PARSER_ADD_LIST(parser,               \
+                      key,                  \
+                      short_name,           \
+                      description,          \
+                      ArgLongLongList,      \
+                      NULL,                 \
+                      (is_required) ? ArgRequired : 0)
+
+#define ARG_PARSER_ADD_DOUBLE_LIST(parser,      \
+                                   key,         \
+                                   short_name,  \
+                                   description, \
+                                   is_required) \
+  ARG_PARSER_ADD_LIST(parser,                   \
+                      key,                      \
+                      short_name,               \
+                      description,              \
+                      ArgDoubleList,            \
+                      NULL,                     \
+                      (is_required) ? ArgRequired : 0)
+
+#define ARG_PARSER_ADD_STR_LIST(parser,      \
+                                key,         \
+                                short_name,  \
+                                description, \
+                                is_required) \
+  ARG_PARSER_ADD_LIST(parser,                \
+                      key,                   \
+                      short_name,            \
+                      description,           \
+                      ArgStringList,         \
+                      NULL,                  \
+                      (is_required) ? ArgRequired : 0)
+
+
+/**\brief define read only list of args
+ * \param list_name name of the list variable
+ * \param ... ARG_STATIC_* entries
+ */
+#define ARG_PARSER_DEFINE_STATIC(list_name, ...) \
+  static const arg_desc list_name[] = {__VA_ARGS__}
+
+/**\brief create parser for list defined by ARG_PARSER_DEFINE_STATIC
+ */
+#define ARG_PARSER_MAKE_STATIC(main_desc, list_name) \
+  arg_parser_make_static(main_desc,                  \
+                         list_name,                  \
+                         sizeof(list_name) / sizeof(list_name[0]))
+
+/**\brief entry of list of args
+ * \param key string literal with normalized name of argument: lower case and
+ * `-` instead of `_`
+ * \param description description of argument, can't be a NULL
+ * \param member member of ArgUnion for default value
+ */
+#define ARG_STATIC_ARG(key,         \
+                       short_name,  \
+                       description, \
+                       type,        \
+                       member,      \
+                       default_val, \
+                       flags)       \
+  {key,                             \
+   description,                     \
+   {.member = default_val},         \
+   type,                            \
+   flags,                           \
+   short_name,                      \
+   sizeof(key) - 1}
+
+#define ARG_STATIC_STR(key, short_name, description, is_required) \
+  ARG_STATIC_ARG(key,                                             \
+                 short_name,                                      \
+                 description,                                     \
+                 ArgString,                                       \
+                 val_str,                                         \
+                 NULL,                                            \
+                 (is_required) ? ArgRequired : 0)
+
+#define ARG_STATIC_INT(key, short_name, description, is_required) \
+  ARG_STATIC_ARG(key,                                             \
+                 short_name,                                      \
+                 description,                                     \
+                 ArgInt,                                          \
+                 val_int,                                         \
+                 0,                                               \
+                 (is_required) ? ArgRequired : 0)
+
+#define ARG_STATIC_LONG(key, short_name, description, is_required) \
+  ARG_STATIC_ARG(key,                                              \
+                 short_name,                                       \
+                 description,                                      \
+                 ArgLong,                                          \
+                 val_long,                                         \
+                 0,                                                \
+                 (is_required) ? ArgRequired : 0)
+
+#define ARG_STATIC_LL(key, short_name, description, is_required) \
+  ARG_STATIC_ARG(key,                                            \
+                 short_name,                                     \
+                 description,                                    \
+                 ArgLongLong,                                    \
+                 val_ll,                                         \
+                 0,                                              \
+                 (is_required) ? ArgRequired : 0)
+
+#define ARG_STATIC_DOUBLE(key, short_name, description, is_required) \
+  ARG_STATIC_ARG(key,                                                \
+                 short_name,                                         \
+                 description,                                        \
+                 ArgDouble,                                          \
+                 val_double,                                         \
+                 0,                                                  \
+                 (is_required) ? ArgRequired : 0)
+
+#define ARG_STATIC_BOOL(key, short_name, description, is_required) \
+  ARG_STATIC_ARG(key,                                              \
+                 short_name,                                       \
+                 description,                                      \
+                 ArgBool,                                          \
+                 val_bool,                                         \
+                 false,                                            \
+                 (is_required) ? ArgRequired : 0)
+
+
+#define ARG_STATIC_STRD(key, short_name, description, default_val) \
+  ARG_STATIC_ARG(key,                                              \
+                 short_name,                                       \
+                 description,                                      \
+                 ArgString,                                        \
+                 val_str,                                          \
+                 default_val,                                      \
+                 ArgDefault)
+
+#define ARG_STATIC_INTD(key, short_name, description, default_val) \
+  ARG_STATIC_ARG(key,                                              \
+                 short_name,                                       \
+                 description,                                      \
+                 ArgInt,                                           \
+                 val_int,                                          \
+                 default_val,                                      \
+                 ArgDefault)
+
+#define ARG_STATIC_LONGD(key, short_name, description, default_val) \
+  ARG_STATIC_ARG(key,                                               \
+                 short_name,                                        \
+                 description,                                       \
+                 ArgLong,                                           \
+                 val_long,                                          \
+                 default_val,                                       \
+                 ArgDefault)
+
+#define ARG_STATIC_LLD(key, short_name, description, default_val) \
+  ARG_STATIC_ARG(key,                                             \
+                 short_name,                                      \
+                 description,                                     \
+                 ArgLongLong,                                     \
+                 val_ll,                                          \
+                 default_val,                                     \
+                 ArgDefault)
+
+#define ARG_STATIC_DOUBLED(key, short_name, description, default_val) \
+  ARG_STATIC_ARG(key,                                                 \
+                 short_name,                                          \
+                 description,                                         \
+                 ArgDouble,                                           \
+                 val_double,                                          \
+                 default_val,                                         \
+                 ArgDefault)
+
+#define ARG_STATIC_BOOLD(key, short_name, description, default_val) \
+  ARG_STATIC_ARG(key,                                               \
+                 short_name,                                        \
+                 description,                                       \
+                 ArgBool,                                           \
+                 val_bool,                                          \
+                 default_val,                                       \
+                 ArgDefault)
+
+/**\param type one of list types @see ArgType
+ */
+#define ARG_STATIC_LIST(key, short_name, description, type, is_required) \
+  ARG_STATIC_ARG(key,                                                    \
+                 short_name,                                             \
+                 description,                                            \
+                 type,                                                   \
+                 val_str,                                                \
+                 NULL,                                                   \
+                 (is_required) ? ArgRequired : 0)
+
 
 /**\brief return flag value
  * \param key complete name of flag
@@ -371,6 +1627,160 @@ int arg_parser_parse(arg_parser *parser,
 #define ARG_PARSER_GET_DOUBLE(parser, key, val) \
   ARG_PARSER_GET_ARG(parser, key, val, double)
 
+/**\brief same as ARG_PARSER_GET_STR, but length of value is returned too
+ * \param len size_t variable for length
+ */
+#define ARG_PARSER_GET_STRN(parser, key, val, len) \
+  arg_parser_hget_strn(parser, arg_parser_handle(parser, key), 0, &val, &len)
+
+
+/**\brief return flag value by handle returned from ARG_PARSER_ADD_*
+ * \param handle handle of flag
+ * \param variable for return
+ * \return 1 in case of success, otherwise return zero or less
+ */
+#define ARG_PARSER_HGET_ARG(parser, handle, val, type)  \
+  arg_parser_hget_args(parser,                          \
+                       handle,                          \
+                       typename2argtype(#type),         \
+                       void_ptr_cast_from_##type(&val), \
+                       1)
+
+/**\brief same as ARG_PARSER_HGET_ARG, but return last value of flag
+ */
+#define ARG_PARSER_HGET_LAST_ARG(parser, handle, val, type) \
+  arg_parser_hget_last(parser,                              \
+                       handle,                              \
+                       typename2argtype(#type),             \
+                       void_ptr_cast_from_##type(&val))
+
+#define ARG_PARSER_HGET_STR(parser, handle, val) \
+  ARG_PARSER_HGET_ARG(parser, handle, val, str)
+
+#define ARG_PARSER_HGET_BOOL(parser, handle, val) \
+  ARG_PARSER_HGET_ARG(parser, handle, val, bool)
+
+#define ARG_PARSER_HGET_INT(parser, handle, val) \
+  ARG_PARSER_HGET_ARG(parser, handle, val, int)
+
+#define ARG_PARSER_HGET_LONG(parser, handle, val) \
+  ARG_PARSER_HGET_ARG(parser, handle, val, long)
+
+#define ARG_PARSER_HGET_LL(parser, handle, val) \
+  ARG_PARSER_HGET_ARG(parser, handle, val, ll)
+
+#define ARG_PARSER_HGET_DOUBLE(parser, handle, val) \
+  ARG_PARSER_HGET_ARG(parser, handle, val, double)
+
+#define ARG_PARSER_HGET_STRN(parser, handle, val, len) \
+  arg_parser_hget_strn(parser, handle, 0, &val, &len)
+
+
+/**\brief same as ARG_PARSER_GET_ARG, but value taken from result filled by
+ * arg_parser_parse_into
+ */
+#define ARG_RESULT_GET_ARG(parser, res, key, val, type) \
+  arg_result_get_args(parser,                           \
+                      res,                              \
+                      key,                              \
+                      typename2argtype(#type),          \
+                      void_ptr_cast_from_##type(&val),  \
+                      1)
+
+#define ARG_RESULT_GET_STR(parser, res, key, val) \
+  ARG_RESULT_GET_ARG(parser, res, key, val, str)
+
+#define ARG_RESULT_GET_BOOL(parser, res, key, val) \
+  ARG_RESULT_GET_ARG(parser, res, key, val, bool)
+
+#define ARG_RESULT_GET_INT(parser, res, key, val) \
+  ARG_RESULT_GET_ARG(parser, res, key, val, int)
+
+#define ARG_RESULT_GET_LONG(parser, res, key, val) \
+  ARG_RESULT_GET_ARG(parser, res, key, val, long)
+
+#define ARG_RESULT_GET_LL(parser, res, key, val) \
+  ARG_RESULT_GET_ARG(parser, res, key, val, ll)
+
+#define ARG_RESULT_GET_DOUBLE(parser, res, key, val) \
+  ARG_RESULT_GET_ARG(parser, res, key, val, double)
+
+
+/**\brief same as ARG_PARSER_HGET_ARG, but value taken from result filled by
+ * arg_parser_parse_into
+ */
+#define ARG_RESULT_HGET_ARG(parser, res, handle, val, type) \
+  arg_result_hget_args(parser,                              \
+                       res,                                 \
+                       handle,                              \
+                       typename2argtype(#type),             \
+                       void_ptr_cast_from_##type(&val),     \
+                       1)
+
+#define ARG_RESULT_HGET_STR(parser, res, handle, val) \
+  ARG_RESULT_HGET_ARG(parser, res, handle, val, str)
+
+#define ARG_RESULT_HGET_BOOL(parser, res, handle, val) \
+  ARG_RESULT_HGET_ARG(parser, res, handle, val, bool)
+
+#define ARG_RESULT_HGET_INT(parser, res, handle, val) \
+  ARG_RESULT_HGET_ARG(parser, res, handle, val, int)
+
+#define ARG_RESULT_HGET_LONG(parser, res, handle, val) \
+  ARG_RESULT_HGET_ARG(parser, res, handle, val, long)
+
+#define ARG_RESULT_HGET_LL(parser, res, handle, val) \
+  ARG_RESULT_HGET_ARG(parser, res, handle, val, ll)
+
+#define ARG_RESULT_HGET_DOUBLE(parser, res, handle, val) \
+  ARG_RESULT_HGET_ARG(parser, res, handle, val, double)
+
+#define ARG_RESULT_HGET_STRN(parser, res, handle, val, len) \
+  arg_result_hget_strn(parser, res, handle, 0, &val, &len)
+
+
+/**\brief return pointer to values of list arg and set len to their count
+ * \param handle handle of list arg
+ * \param len unsigned variable for count of values
+ */
+#define ARG_PARSER_HGET_INT_LIST(parser, handle, len) \
+  ((const int *)arg_parser_hget_list(parser, handle, ArgIntList, &(len)))
+
+#define ARG_PARSER_HGET_LONG_LIST(parser, handle, len) \
+  ((const long *)arg_parser_hget_list(parser, handle, ArgLongList, &(len)))
+
+#define ARG_PARSER_HGET_LL_LIST(parser, handle, len) \
+  ((const long long *)                               \
+       arg_parser_hget_list(parser, handle, ArgLongLongList, &(len)))
+
+#define ARG_PARSER_HGET_DOUBLE_LIST(parser, handle, len) \
+  ((const double *)arg_parser_hget_list(parser, handle, ArgDoubleList, &(len)))
+
+#define ARG_PARSER_HGET_STR_LIST(parser, handle, len) \
+  ((const char *const *)                              \
+       arg_parser_hget_list(parser, handle, ArgStringList, &(len)))
+
+/**\brief same as ARG_PARSER_HGET_*_LIST, but values taken from given result
+ */
+#define ARG_RESULT_HGET_INT_LIST(parser, res, handle, len) \
+  ((const int *)arg_result_hget_list(parser, res, handle, ArgIntList, &(len)))
+
+#define ARG_RESULT_HGET_LONG_LIST(parser, res, handle, len) \
+  ((const long *)                                           \
+       arg_result_hget_list(parser, res, handle, ArgLongList, &(len)))
+
+#define ARG_RESULT_HGET_LL_LIST(parser, res, handle, len) \
+  ((const long long *)                                    \
+       arg_result_hget_list(parser, res, handle, ArgLongLongList, &(len)))
+
+#define ARG_RESULT_HGET_DOUBLE_LIST(parser, res, handle, len) \
+  ((const double *)                                           \
+       arg_result_hget_list(parser, res, handle, ArgDoubleList, &(len)))
+
+#define ARG_RESULT_HGET_STR_LIST(parser, res, handle, len) \
+  ((const char *const *)                                   \
+       arg_result_hget_list(parser, res, handle, ArgStringList, &(len)))
+
 
 inline enum ArgType typename2argtype(const char *type_name) {
   if (strcmp(type_name, "str") == 0) {
@@ -393,74 +1803,481 @@ inline enum ArgType typename2argtype(const char *type_name) {
 }
 
 inline char *val_to_string(union ArgUnion val, enum ArgType type) {
-  char *retval = (char *)malloc(ARG_MAX_VALUE_LEN);
-  int   count  = 0;
+  char        buf[ARG_MAX_NUM_LEN];
+  const char *str    = NULL;
+  unsigned    len    = arg_format_val(val, type, buf, &str);
+  char *      retval = (char *)malloc(len + 1);
+  memcpy(retval, str, len);
+  retval[len] = '\0';
+  return retval;
+}
+
+inline unsigned arg_type_size(enum ArgType type) {
   switch (type) {
   case ArgString:
-    count = snprintf(retval, ARG_MAX_VALUE_LEN, "%s", val.val_str);
-    break;
+    return sizeof(const char *);
+  case ArgBool:
+    return sizeof(bool);
   case ArgInt:
-    count = snprintf(retval, ARG_MAX_VALUE_LEN, "%i", val.val_int);
-    break;
+    return sizeof(int);
   case ArgLong:
-    count = snprintf(retval, ARG_MAX_VALUE_LEN, "%li", val.val_long);
-    break;
+    return sizeof(long);
   case ArgLongLong:
-    count = snprintf(retval, ARG_MAX_VALUE_LEN, "%lli", val.val_ll);
-    break;
-  case ArgBool:
-    count = snprintf(retval,
-                     ARG_MAX_VALUE_LEN,
-                     "%s",
-                     val.val_bool ? "true" : "false");
-    break;
+    return sizeof(long long);
   case ArgDouble:
-    count = snprintf(retval, ARG_MAX_VALUE_LEN, "%f", val.val_double);
-    break;
-  }
-  if (count >= ARG_MAX_VALUE_LEN) {
-    retval[ARG_MAX_VALUE_LEN - 1] = '\0';
+    return sizeof(double);
+  case ArgIntList:
+  case ArgLongList:
+  case ArgLongLongList:
+  case ArgDoubleList:
+  case ArgStringList:
+    return arg_type_size(arg_list_elem(type));
   }
-  return retval;
+
+  assert(0 && "unknown arg type");
+  return sizeof(union ArgUnion);
 }
 
-inline char *str_to_arg_name(const char *name) {
-  unsigned len    = strlen(name);
-  char *   retval = (char *)malloc(len + 1);
-  strcpy(retval, name);
-  for (unsigned i = 0; i < len; ++i) {
-    if ('_' == retval[i]) {
-      retval[i] = '-';
-      continue;
-    }
-    retval[i] = tolower(retval[i]);
+/**\return type of values of list type or type itself for other types
+ */
+inline enum ArgType arg_list_elem(enum ArgType type) {
+  switch (type) {
+  case ArgIntList:
+    return ArgInt;
+  case ArgLongList:
+    return ArgLong;
+  case ArgLongLongList:
+    return ArgLongLong;
+  case ArgDoubleList:
+    return ArgDouble;
+  case ArgStringList:
+    return ArgString;
+  default:
+    return type;
   }
-  return retval;
 }
 
-inline int str_arg_cmp(const char *lhs, const char *rhs) {
-  for (unsigned i = 0; i < strlen(lhs) && i < strlen(rhs); ++i) {
-    char lhs_c = tolower(lhs[i]);
-    char rhs_c = tolower(rhs[i]);
-    if (lhs_c == '_') {
-      lhs_c = '-';
-    }
-    if (rhs_c == '_') {
-      rhs_c = '-';
-    }
+/**\brief convert string to value of given type
+ * \return 0 in case of success, otherwise non zero value
+ * \note integers are accepted in same formats as by strtol with base 0, but
+ * values out of range of the type are errors
+ */
+inline int
+arg_val_from_str(enum ArgType type, const char *str, union ArgUnion *val) {
+  return arg_val_from_range(type, str, str + strlen(str), val);
+}
 
-    if (lhs_c != rhs_c) {
-      return i + 1;
+/**\brief same as arg_val_from_str, but string ends by end, list types are
+ * converted as one value
+ * \note string value points to str and is not terminated by end
+ */
+inline int arg_val_from_range(enum ArgType    type,
+                              const char *    str,
+                              const char *    end,
+                              union ArgUnion *val) {
+  long long retval = 0;
+  int       status = 0;
+  switch (arg_list_elem(type)) {
+  case ArgString:
+    val->val_str = str;
+    return 0;
+  case ArgBool:
+    if (end - str == 4 && memcmp(str, "true", 4) == 0) {
+      val->val_bool = true;
+      return 0;
+    } else if (end - str == 5 && memcmp(str, "false", 5) == 0) {
+      val->val_bool = false;
+      return 0;
     }
+    status        = arg_parse_ll(str, end, LLONG_MIN, LLONG_MAX, &retval);
+    val->val_bool = retval != 0;
+    return status;
+  case ArgInt:
+    status       = arg_parse_ll(str, end, INT_MIN, INT_MAX, &retval);
+    val->val_int = (int)retval;
+    return status;
+  case ArgLong:
+    status        = arg_parse_ll(str, end, LONG_MIN, LONG_MAX, &retval);
+    val->val_long = (long)retval;
+    return status;
+  case ArgLongLong:
+    return arg_parse_ll(str, end, LLONG_MIN, LLONG_MAX, &val->val_ll);
+  case ArgDouble:
+    return arg_parse_double(str, end, &val->val_double);
+  default:
+    return 1;
   }
+}
 
-  return 0;
+/**\return non zero for space symbols skipped by strtol in "C" locale
+ */
+inline int arg_is_space(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
 }
 
-inline int
-arg_name_cmp(const char *arg_name, char short_name, const char *val_for_comp) {
-  unsigned arg_len = strlen(arg_name);
-  unsigned val_len = strlen(val_for_comp);
+/**\return value of decimal or hex digit, or 255 for other symbols
+ */
+inline unsigned arg_digit(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return 255;
+}
+
+/**\return non zero if all 8 bytes of chunk are decimal digits
+ */
+inline int arg_swar_is_digits(uint64_t chunk) {
+  // high nibbles must be 3, and adding 6 must not carry out of low nibbles
+  return ((chunk & 0xF0F0F0F0F0F0F0F0u) |
+          (((chunk + 0x0606060606060606u) & 0xF0F0F0F0F0F0F0F0u) >> 4)) ==
+         0x3333333333333333u;
+}
+
+/**\return value of 8 decimal digits loaded as little endian chunk
+ */
+inline uint32_t arg_swar_digits(uint64_t chunk) {
+  const uint64_t mask = 0x000000FF000000FFu;
+  const uint64_t mul1 = 100 + (1000000ull << 32);
+  const uint64_t mul2 = 1 + (10000ull << 32);
+
+  chunk -= 0x3030303030303030u;
+  chunk = chunk * 10 + (chunk >> 8); // pairs of digits
+  chunk = ((chunk & mask) * mul1 + ((chunk >> 16) & mask) * mul2) >> 32;
+  return (uint32_t)chunk;
+}
+
+/**\brief parse integer from [str, end) in same formats as strtol with base 0:
+ * leading spaces, optional sign, `0x` prefix for hex, `0` prefix for octal
+ * \return 0 in case of success, non zero if there are no digits, unexpected
+ * symbols or value is out of [min, max]
+ */
+inline int arg_parse_ll(const char *str,
+                        const char *end,
+                        long long   min,
+                        long long   max,
+                        long long * val) {
+  unsigned long long limit = (unsigned long long)max;
+  unsigned long long acc   = 0;
+  unsigned           base  = 10;
+  bool               neg   = false;
+
+  while (str < end && arg_is_space(*str)) {
+    ++str;
+  }
+  if (str < end && (*str == '+' || *str == '-')) {
+    neg = *str++ == '-';
+  }
+  if (neg) {
+    limit = (unsigned long long)(-(min + 1)) + 1;
+  }
+
+  if (end - str > 1 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+    base = 16;
+    str += 2;
+  } else if (end - str > 1 && str[0] == '0') {
+    base = 8;
+    ++str;
+  }
+  if (str == end) {
+    return 1;
+  }
+
+#ifdef ARG_PARSER_SWAR
+  for (; base == 10 && end - str >= 8; str += 8) {
+    uint64_t chunk;
+    memcpy(&chunk, str, sizeof(chunk));
+    if (!arg_swar_is_digits(chunk)) {
+      break;
+    }
+
+    uint32_t digits = arg_swar_digits(chunk);
+    if (digits > limit || acc > (limit - digits) / 100000000u) {
+      return 1;
+    }
+    acc = acc * 100000000u + digits;
+  }
+#endif
+
+  for (; str < end; ++str) {
+    unsigned digit = arg_digit(*str);
+    if (digit >= base) {
+      return 1;
+    }
+    if (digit > limit || acc > (limit - digit) / base) {
+      return 1;
+    }
+    acc = acc * base + digit;
+  }
+
+  if (neg && acc != 0) {
+    *val = -(long long)(acc - 1) - 1;
+  } else {
+    *val = (long long)acc;
+  }
+  return 0;
+}
+
+/**\brief parse double from [str, end)
+ * \return 0 in case of success, otherwise non zero value
+ * \note decimal numbers with up to 19 significant digits, mantissa up to 2^53
+ * and exponent in [-22, 22] are converted exactly by one multiplication or
+ * division of doubles (Clinger fast path). Other numbers, hex floats, inf and
+ * nan are converted by strtod, @see arg_strtod. Decimal point is always `.`
+ * regardless of LC_NUMERIC
+ */
+inline int arg_parse_double(const char *str, const char *end, double *val) {
+  const char *       iter   = str;
+  unsigned long long mant   = 0;
+  int                digits = 0; // significant digits in mant
+  int                exp10  = 0;
+  int                any    = 0; // count of digits before exponent
+  bool               neg    = false;
+
+  while (iter < end && arg_is_space(*iter)) {
+    ++iter;
+  }
+  if (iter < end && (*iter == '+' || *iter == '-')) {
+    neg = *iter++ == '-';
+  }
+
+  for (; iter < end && *iter >= '0' && *iter <= '9'; ++iter, ++any) {
+    if (digits == 19) {
+      goto Fallback;
+    }
+    mant = mant * 10 + (*iter - '0');
+    digits += mant != 0;
+  }
+  if (iter < end && *iter == '.') {
+    for (++iter; iter < end && *iter >= '0' && *iter <= '9'; ++iter, ++any) {
+      if (digits == 19) {
+        goto Fallback;
+      }
+      mant = mant * 10 + (*iter - '0');
+      digits += mant != 0;
+      --exp10;
+    }
+  }
+  if (any == 0) {
+    goto Fallback; // inf, nan or garbage
+  }
+
+  if (iter < end && (*iter == 'e' || *iter == 'E')) {
+    bool exp_neg = false;
+    int  exp     = 0;
+    ++iter;
+    if (iter < end && (*iter == '+' || *iter == '-')) {
+      exp_neg = *iter++ == '-';
+    }
+    if (iter == end) {
+      return 1;
+    }
+    for (; iter < end && *iter >= '0' && *iter <= '9'; ++iter) {
+      if (exp > 100000) {
+        goto Fallback;
+      }
+      exp = exp * 10 + (*iter - '0');
+    }
+    exp10 += exp_neg ? -exp : exp;
+  }
+  if (iter != end) {
+    goto Fallback; // hex or garbage
+  }
+
+  if (mant == 0) {
+    *val = neg ? -0.0 : 0.0;
+    return 0;
+  }
+#ifdef ARG_PARSER_FAST_FLOAT
+  if (mant <= (1ull << 53) && exp10 >= -22 && exp10 <= 22) {
+    static const double pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                   1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                   1e18, 1e19, 1e20, 1e21, 1e22};
+
+    double retval = (double)mant;
+    retval        = exp10 < 0 ? retval / pow10[-exp10] : retval * pow10[exp10];
+    *val          = neg ? -retval : retval;
+    return 0;
+  }
+#endif
+
+Fallback:
+  return arg_strtod(str, end, localeconv()->decimal_point, val);
+}
+
+/**\brief convert [str, end) by strtod, which uses decimal point of locale
+ * \param point decimal point of current locale
+ * \return 0 in case of success, otherwise non zero value
+ * \note if point is not `.`, then number is copied with point instead of
+ * `.`, and number with locale point is rejected, so result doesn't depend on
+ * LC_NUMERIC. strtod_l is not used, because it isn't available everywhere
+ */
+inline int arg_strtod(const char *str,
+                      const char *end,
+                      const char *point,
+                      double *    val) {
+  char   buf[ARG_MAX_NUM_LEN];
+  char * copy   = buf;
+  char * write  = NULL;
+  char * endval = NULL;
+  size_t plen   = strlen(point);
+  size_t size   = 1;
+  int    retval = 1;
+  if (plen == 1 && point[0] == '.') {
+    *val = strtod(str, &endval);
+    return endval == str || endval != end;
+  }
+
+  for (const char *iter = str; iter < end; ++iter) {
+    if (plen != 0 && *iter == point[0]) {
+      return 1;
+    }
+    size += *iter == '.' ? plen : 1;
+  }
+  if (size > sizeof(buf)) {
+    copy = (char *)malloc(size);
+    if (copy == NULL) {
+      return 1;
+    }
+  }
+
+  write = copy;
+  for (const char *iter = str; iter < end; ++iter) {
+    if (*iter == '.') {
+      memcpy(write, point, plen);
+      write += plen;
+    } else {
+      *write++ = *iter;
+    }
+  }
+  *write = '\0';
+
+  *val   = strtod(copy, &endval);
+  retval = endval == copy || endval != write;
+  if (copy != buf) {
+    free(copy);
+  }
+  return retval;
+}
+
+/**\return count of trailing zero bits, val must be non zero
+ */
+inline unsigned arg_ctz(uint64_t val) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(val);
+#else
+  unsigned count = 0;
+  for (; (val & 1) == 0; val >>= 1) {
+    ++count;
+  }
+  return count;
+#endif
+}
+
+inline unsigned arg_popcount(uint64_t val) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(val);
+#else
+  unsigned count = 0;
+  for (; val; val &= val - 1) {
+    ++count;
+  }
+  return count;
+#endif
+}
+
+/**\return chunk with high bit set exactly in bytes equal to c
+ */
+inline uint64_t arg_swar_eq(uint64_t chunk, char c) {
+  const uint64_t low  = 0x7f7f7f7f7f7f7f7full;
+  uint64_t       diff = chunk ^ (0x0101010101010101ull * (unsigned char)c);
+  return ~(((diff & low) + low) | diff | low);
+}
+
+/**\return first ARG_LIST_SEP in [str, end) or end if there is no one
+ */
+inline const char *arg_find_sep(const char *str, const char *end) {
+#ifdef ARG_PARSER_SSE2
+  const __m128i sep = _mm_set1_epi8(ARG_LIST_SEP);
+  for (; end - str >= 16; str += 16) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *)str);
+    int     mask  = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, sep));
+    if (mask) {
+      return str + arg_ctz(mask);
+    }
+  }
+#endif
+#ifdef ARG_PARSER_SWAR
+  for (; end - str >= 8; str += 8) {
+    uint64_t chunk;
+    memcpy(&chunk, str, sizeof(chunk));
+    uint64_t mask = arg_swar_eq(chunk, ARG_LIST_SEP);
+    if (mask) {
+      return str + arg_ctz(mask) / 8;
+    }
+  }
+#endif
+  while (str < end && *str != ARG_LIST_SEP) {
+    ++str;
+  }
+  return str;
+}
+
+/**\return count of ARG_LIST_SEP in [str, end)
+ */
+inline unsigned arg_count_sep(const char *str, const char *end) {
+  unsigned count = 0;
+#ifdef ARG_PARSER_SSE2
+  const __m128i sep = _mm_set1_epi8(ARG_LIST_SEP);
+  for (; end - str >= 16; str += 16) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *)str);
+    count += arg_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, sep)));
+  }
+#endif
+  // counting by bytes doesn't depend on byte order
+  for (; end - str >= 8; str += 8) {
+    uint64_t chunk;
+    memcpy(&chunk, str, sizeof(chunk));
+    count += arg_popcount(arg_swar_eq(chunk, ARG_LIST_SEP));
+  }
+  for (; str < end; ++str) {
+    count += *str == ARG_LIST_SEP;
+  }
+  return count;
+}
+
+inline char *str_to_arg_name(const char *name) {
+  unsigned len    = strlen(name);
+  char *   retval = (char *)malloc(len + 1);
+  strcpy(retval, name);
+  for (unsigned i = 0; i < len; ++i) {
+    if ('_' == retval[i]) {
+      retval[i] = '-';
+      continue;
+    }
+    retval[i] = tolower(retval[i]);
+  }
+  return retval;
+}
+
+inline int str_arg_cmp(const char *lhs, const char *rhs) {
+  for (unsigned i = 0; lhs[i] != '\0' && rhs[i] != '\0'; ++i) {
+    if (arg_name_char(lhs[i]) != arg_name_char(rhs[i])) {
+      return i + 1;
+    }
+  }
+
+  return 0;
+}
+
+inline int
+arg_name_cmp(const char *arg_name, char short_name, const char *val_for_comp) {
+  unsigned arg_len = strlen(arg_name);
+  unsigned val_len = strlen(val_for_comp);
 
   if (val_len >= 2 && val_for_comp[0] == '-' && val_for_comp[1] == short_name &&
       (val_len == 2 || val_for_comp[2] == '=')) {
@@ -471,353 +2288,2358 @@ arg_name_cmp(const char *arg_name, char short_name, const char *val_for_comp) {
     return 1;
   }
 
-  if (val_for_comp[0] != '-' && val_for_comp[1] != '-') {
-    return 2;
+  if (val_for_comp[0] != '-' && val_for_comp[1] != '-') {
+    return 2;
+  }
+
+  if (val_len > arg_len + 2 && val_for_comp[arg_len + 2] != '=') {
+    return 3;
+  }
+
+  if (str_arg_cmp(arg_name, val_for_comp + 2) != 0) {
+    return 4;
+  }
+
+  return 0;
+}
+
+/**\brief allocate new block with given capacity and make it current
+ */
+inline void arg_arena_add_block(arg_arena *arena, size_t size) {
+  const size_t header = ARG_ARENA_ROUND(sizeof(arg_arena_block));
+
+  arg_arena_block *block = (arg_arena_block *)malloc(header + size);
+  block->prev            = arena->head;
+  block->size            = size;
+  block->used            = 0;
+  arena->head            = block;
+  ++arena->nallocs;
+}
+
+/**\brief allocate first block of arena with exactly given capacity, so small
+ * arenas don't take whole ARG_ARENA_BLOCK_SIZE
+ * \note does nothing if arena already has blocks
+ */
+inline void arg_arena_reserve(arg_arena *arena, size_t size) {
+  if (arena->head == NULL) {
+    arg_arena_add_block(arena, ARG_ARENA_ROUND(size));
+  }
+}
+
+inline void *arg_arena_alloc(arg_arena *arena, size_t size) {
+  const size_t header = ARG_ARENA_ROUND(sizeof(arg_arena_block));
+  size                = ARG_ARENA_ROUND(size);
+
+  arg_arena_block *block = arena->head;
+  if (block == NULL || block->size - block->used < size) {
+    size_t block_size = block ? block->size * 2 : ARG_ARENA_BLOCK_SIZE;
+    while (block_size < size) {
+      block_size *= 2;
+    }
+
+    arg_arena_add_block(arena, block_size);
+    block = arena->head;
+  }
+
+  arena->last = (char *)block + header + block->used;
+  block->used += size;
+  return arena->last;
+}
+
+/**\brief grow memory allocated from arena
+ * \note if ptr is the last allocation and fit to current block, then it will
+ * be grown in place, otherwise data copied to new place
+ */
+inline void *
+arg_arena_grow(arg_arena *arena, void *ptr, size_t size, size_t new_size) {
+  size_t aligned     = ARG_ARENA_ROUND(size);
+  size_t new_aligned = ARG_ARENA_ROUND(new_size);
+
+  arg_arena_block *block = arena->head;
+  if (ptr != NULL && ptr == arena->last &&
+      block->size - block->used >= new_aligned - aligned) {
+    block->used += new_aligned - aligned;
+    return ptr;
+  }
+
+  void *retval = arg_arena_alloc(arena, new_size);
+  if (ptr != NULL) {
+    memcpy(retval, ptr, size);
+  }
+  return retval;
+}
+
+inline char *arg_arena_strdup(arg_arena *arena, const char *str) {
+  size_t len    = str ? strlen(str) : 0;
+  char * retval = (char *)arg_arena_alloc(arena, len + 1);
+  memcpy(retval, str ? str : "", len);
+  retval[len] = '\0';
+  return retval;
+}
+
+/**\brief map file to memory, the mapping is writable and private
+ * \param id if not NULL, then set to identity of the file
+ * \return pointer to content with `\0` after the end or NULL if file can't be
+ * read
+ */
+inline char *arg_result_map_file(arg_result * res,
+                                 const char * path,
+                                 size_t *     size,
+                                 arg_file_id *id) {
+#ifdef ARG_PARSER_POSIX
+  struct stat st;
+#endif
+  if (id) {
+    id->dev  = 0;
+    id->ino  = 0;
+    id->path = path;
+  }
+
+#ifdef ARG_PARSER_MMAP
+  int fd = open(path, O_RDONLY);
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    return NULL;
+  }
+  if (id) {
+    id->dev = (uint64_t)st.st_dev;
+    id->ino = (uint64_t)st.st_ino;
+  }
+
+  // reserve one more byte after the file for `\0`, pages after end of file
+  // are zero filled
+  *size      = st.st_size;
+  char *addr = (char *)mmap(NULL,
+                            *size + 1,
+                            PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | ARG_PARSER_MMAP,
+                            -1,
+                            0);
+  if (addr != MAP_FAILED && *size != 0 &&
+      mmap(addr,
+           *size,
+           PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_FIXED,
+           fd,
+           0) == MAP_FAILED) {
+    munmap(addr, *size + 1);
+    addr = (char *)MAP_FAILED;
+  }
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return NULL;
+  }
+
+  arg_mapping *mapping =
+      (arg_mapping *)arg_arena_alloc(&res->arena, sizeof(arg_mapping));
+  mapping->prev = res->mlist;
+  mapping->addr = addr;
+  mapping->size = *size + 1;
+  res->mlist    = mapping;
+  return addr;
+#else
+#  ifdef ARG_PARSER_POSIX
+  if (id && stat(path, &st) == 0) {
+    id->dev = (uint64_t)st.st_dev;
+    id->ino = (uint64_t)st.st_ino;
+  }
+#  endif
+  FILE *file = fopen(path, "rb");
+  if (file == NULL || fseek(file, 0, SEEK_END) != 0) {
+    if (file) {
+      fclose(file);
+    }
+    return NULL;
+  }
+
+  *size        = ftell(file);
+  char *retval = (char *)arg_arena_alloc(&res->arena, *size + 1);
+  fseek(file, 0, SEEK_SET);
+  *size         = fread(retval, 1, *size, file);
+  retval[*size] = '\0';
+  fclose(file);
+  return retval;
+#endif
+}
+
+/**\brief split content to args in place: args separated by spaces, `'` and
+ * `"` quote spaces, `\` escapes next symbol (except inside `'`)
+ * \param iter current position, moved to start of next arg
+ * \param end end of content, must be writable
+ * \return next arg or NULL
+ */
+inline char *arg_next_token(char **iter, char *end) {
+  char *read = *iter;
+  while (read < end && isspace((unsigned char)*read)) {
+    ++read;
+  }
+  if (read == end) {
+    *iter = end;
+    return NULL;
+  }
+
+  char *retval = read;
+  char *write  = read;
+  char  quote  = 0;
+  for (; read < end; ++read) {
+    if (quote == 0 && isspace((unsigned char)*read)) {
+      break;
+    } else if (*read == quote) {
+      quote = 0;
+    } else if (quote == 0 && (*read == '"' || *read == '\'')) {
+      quote = *read;
+    } else if (*read == '\\' && quote != '\'' && read + 1 < end) {
+      *write++ = *++read;
+    } else {
+      *write++ = *read;
+    }
+  }
+
+  *iter  = read < end ? read + 1 : end;
+  *write = '\0';
+  return retval;
+}
+
+inline void arg_argv_push(arg_arena *arena, arg_argv *args, char *arg) {
+  if (args->size == args->cap) {
+    unsigned new_cap = args->cap ? args->cap * 2 : 64;
+
+    args->list = (char **)arg_arena_grow(arena,
+                                         args->list,
+                                         sizeof(char *) * args->cap,
+                                         sizeof(char *) * new_cap);
+    args->cap  = new_cap;
+  }
+  args->list[args->size++] = arg;
+}
+
+/**\return non zero if identities refer to same file
+ */
+inline int arg_file_same(const arg_file_id *lhs, const arg_file_id *rhs) {
+  if (lhs->dev != 0 || lhs->ino != 0 || rhs->dev != 0 || rhs->ino != 0) {
+    return lhs->dev == rhs->dev && lhs->ino == rhs->ino;
+  }
+  return strcmp(lhs->path, rhs->path) == 0;
+}
+
+/**\brief push arg to args or args from file if arg is `@path`
+ * \param chain identities of files, which are expanded now, by depth
+ * \param cycle set to true if file includes itself directly or by other files
+ * \return NULL in case of success, otherwise path of failed file
+ */
+inline const char *arg_result_expand_arg(arg_result * res,
+                                         arg_argv *   args,
+                                         char *       arg,
+                                         int          depth,
+                                         arg_file_id *chain,
+                                         bool *       cycle) {
+  if (arg[0] != '@' || arg[1] == '\0' || depth == ARG_MAX_FILE_DEPTH) {
+    arg_argv_push(&res->arena, args, arg);
+    return NULL;
+  }
+
+  size_t size = 0;
+  char * iter = arg_result_map_file(res, arg + 1, &size, &chain[depth]);
+  if (iter == NULL) {
+    return arg + 1;
+  }
+  for (int i = 0; i < depth; ++i) {
+    if (arg_file_same(&chain[i], &chain[depth])) {
+      *cycle = true;
+      return arg + 1;
+    }
+  }
+
+  char *end = iter + size;
+  for (char *token; (token = arg_next_token(&iter, end)) != NULL;) {
+    const char *retval =
+        arg_result_expand_arg(res, args, token, depth + 1, chain, cycle);
+    if (retval) {
+      return retval;
+    }
+  }
+  return NULL;
+}
+
+/**\brief replace `@path` args by content of files
+ * \param cycle set to true if failed file includes itself
+ * \return NULL in case of success, otherwise path of file which can't be read
+ * \note argv is not changed if it has no `@path` args
+ */
+inline const char *
+arg_result_expand(arg_result *res, int *argc, char **argv[], bool *cycle) {
+  arg_file_id chain[ARG_MAX_FILE_DEPTH];
+  int first = 1;
+  while (first < *argc && ((*argv)[first][0] != '@' || !(*argv)[first][1])) {
+    ++first;
+  }
+  if (first == *argc) {
+    return NULL;
+  }
+
+  arg_argv args = {NULL, 0, 0};
+  for (int i = 0; i < first; ++i) {
+    arg_argv_push(&res->arena, &args, (*argv)[i]);
+  }
+  for (int i = first; i < *argc; ++i) {
+    const char *retval =
+        arg_result_expand_arg(res, &args, (*argv)[i], 0, chain, cycle);
+    if (retval) {
+      return retval;
+    }
+  }
+  arg_argv_push(&res->arena, &args, NULL);
+
+  *argc = args.size - 1;
+  *argv = args.list;
+  return NULL;
+}
+
+/**\brief free memory allocated after given position, newer blocks are joined
+ * to one block, so same allocations fit to it next time without allocation
+ * from system
+ * \param block block of the position, must be in arena
+ */
+inline void
+arg_arena_rewind(arg_arena *arena, arg_arena_block *block, size_t used) {
+  size_t   size  = 0;
+  unsigned count = 0;
+  for (arg_arena_block *iter = arena->head; iter != block; iter = iter->prev) {
+    size += iter->size;
+    ++count;
+  }
+
+  if (count == 1) {
+    arena->head->used = 0;
+  } else if (count > 1) {
+    while (arena->head != block) {
+      arg_arena_block *prev = arena->head->prev;
+      free(arena->head);
+      arena->head = prev;
+    }
+    arg_arena_add_block(arena, size);
+  }
+  block->used = used;
+  arena->last = NULL;
+}
+
+inline void arg_arena_release(arg_arena *arena) {
+  while (arena->head) {
+    arg_arena_block *prev = arena->head->prev;
+    free(arena->head);
+    arena->head = prev;
+  }
+  arena->last = NULL;
+}
+
+/**\return symbol of normalized name: lower case and `-` instead of `_`
+ */
+inline char arg_name_char(char c) {
+  if (c == '_') {
+    return '-';
+  }
+  return tolower((unsigned char)c);
+}
+
+/**\return FNV-1a hash of first len symbols of normalized name
+ */
+inline unsigned arg_name_hash(const char *name, unsigned len) {
+  unsigned hash = 2166136261u;
+  for (unsigned i = 0; i < len; ++i) {
+    hash ^= (unsigned char)arg_name_char(name[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/**\return non zero if normalized arg_name equal to first len symbols of name
+ * \note arg_name must be already normalized and has length len
+ */
+inline int arg_name_eq(const char *arg_name, const char *name, unsigned len) {
+  for (unsigned i = 0; i < len; ++i) {
+    if (arg_name[i] != arg_name_char(name[i])) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**\brief insert arg with given index to htable and stable
+ * \note if arg with same name already exists, then the first one stays
+ */
+inline void arg_parser_index_arg(arg_parser *parser, unsigned arg_iter) {
+  arg_desc *arg = &parser->alist[arg_iter];
+
+  if (arg->shrt && parser->stable[(unsigned char)arg->shrt] == 0) {
+    parser->stable[(unsigned char)arg->shrt] = arg_iter + 1;
+  }
+
+  if (parser->asize * 2 > parser->hcap) {
+    unsigned new_cap = parser->hcap ? parser->hcap * 2 : 16;
+    unsigned size    = sizeof(arg_hentry) * new_cap;
+
+    parser->htable = (arg_hentry *)arg_arena_alloc(&parser->arena, size);
+    parser->hcap   = new_cap;
+    memset(parser->htable, 0, size);
+    for (unsigned i = 0; i < arg_iter; ++i) {
+      arg_parser_index_arg(parser, i);
+    }
+  }
+
+  unsigned hash = arg_name_hash(arg->name, arg->nlen);
+  unsigned mask = parser->hcap - 1;
+  for (unsigned i = hash & mask;; i = (i + 1) & mask) {
+    arg_hentry *entry = &parser->htable[i];
+    if (entry->aidx == 0) {
+      entry->hash = hash;
+      entry->aidx = arg_iter + 1;
+      return;
+    }
+
+    arg_desc *other = &parser->alist[entry->aidx - 1];
+    if (entry->hash == hash && other->nlen == arg->nlen &&
+        arg_name_eq(other->name, arg->name, arg->nlen)) {
+      return;
+    }
+  }
+}
+
+/**\return index of arg with given long name (first len symbols, not
+ * normalized) or -1 if not found
+ */
+inline int
+arg_parser_find(const arg_parser *parser, const char *name, unsigned len) {
+  if (parser->hcap == 0) {
+    return -1;
+  }
+
+  unsigned hash = arg_name_hash(name, len);
+  unsigned mask = parser->hcap - 1;
+  for (unsigned i = hash & mask;; i = (i + 1) & mask) {
+    const arg_hentry *entry = &parser->htable[i];
+    if (entry->aidx == 0) {
+      return -1;
+    }
+
+    const arg_desc *arg = &parser->alist[entry->aidx - 1];
+    if (entry->hash == hash && arg->nlen == len &&
+        arg_name_eq(arg->name, name, len)) {
+      return entry->aidx - 1;
+    }
+  }
+}
+
+/**\brief find arg for flag in forms: `--name`, `--name=val`, `-n`, `-n=val`,
+ * `-nval` and clusters of short flags `-abn`, `-abnval`, `-abn=val`, where
+ * all flags except the last one are bool
+ * \param val set to value after `=`, attached value or NULL
+ * \param bools set to count of bool flags at begin of cluster, which precede
+ * the found one, @see arg_result_store_bools
+ * \return index of arg or -1 if flag is unknown
+ * \note every short name is resolved by stable, cluster with unknown name is
+ * unknown as a whole
+ */
+inline int arg_parser_match(const arg_parser *parser,
+                            const char *      flag,
+                            const char **     val,
+                            unsigned *        bools) {
+  *val   = NULL;
+  *bools = 0;
+  if (flag[0] != '-' || flag[1] == '\0') {
+    return -1;
+  }
+
+  if (flag[1] != '-') {
+    for (unsigned i = 1;; ++i) {
+      int arg_iter = (int)parser->stable[(unsigned char)flag[i]] - 1;
+      if (arg_iter < 0) {
+        return -1;
+      }
+
+      *bools = i - 1;
+      if (flag[i + 1] == '=') {
+        *val = flag + i + 2;
+        return arg_iter;
+      }
+      if (flag[i + 1] == '\0') {
+        return arg_iter;
+      }
+      if (parser->alist[arg_iter].type != ArgBool) {
+        *val = flag + i + 1; // attached value
+        return arg_iter;
+      }
+    }
+  }
+
+  const char *name = flag + 2;
+  unsigned    len  = 0;
+  while (name[len] != '\0' && name[len] != '=') {
+    ++len;
+  }
+  if (name[len] == '=') {
+    *val = name + len + 1;
+  }
+
+  int arg_iter = arg_parser_find(parser, name, len);
+  if (arg_iter < 0 && (parser->opts & ArgParserAbbrev)) {
+    arg_iter = arg_parser_find_prefix(parser, name, len);
+  }
+  return arg_iter;
+}
+
+/**\brief set to true bool flags at begin of cluster of short flags
+ * \param bools count of the flags returned by arg_parser_match
+ */
+inline void arg_result_store_bools(const arg_parser *parser,
+                                   arg_result *      res,
+                                   const char *      flag,
+                                   unsigned          bools) {
+  for (unsigned i = 1; i <= bools; ++i) {
+    int arg_iter = (int)parser->stable[(unsigned char)flag[i]] - 1;
+    arg_result_store(parser, res, arg_iter, "true");
+  }
+}
+
+/**\brief insert subcommand with given index to ctable
+ * \note if subcommand with same name already exists, then the first one stays
+ */
+inline void arg_parser_index_cmd(arg_parser *parser, unsigned cmd_iter) {
+  arg_cmd *cmd = &parser->clist[cmd_iter];
+
+  if (parser->csize * 2 > parser->ctcap) {
+    unsigned new_cap = parser->ctcap ? parser->ctcap * 2 : 16;
+    unsigned size    = sizeof(arg_hentry) * new_cap;
+
+    parser->ctable = (arg_hentry *)arg_arena_alloc(&parser->arena, size);
+    parser->ctcap  = new_cap;
+    memset(parser->ctable, 0, size);
+    for (unsigned i = 0; i < cmd_iter; ++i) {
+      arg_parser_index_cmd(parser, i);
+    }
+  }
+
+  unsigned hash = arg_name_hash(cmd->name, cmd->nlen);
+  unsigned mask = parser->ctcap - 1;
+  for (unsigned i = hash & mask;; i = (i + 1) & mask) {
+    arg_hentry *entry = &parser->ctable[i];
+    if (entry->aidx == 0) {
+      entry->hash = hash;
+      entry->aidx = cmd_iter + 1;
+      return;
+    }
+
+    arg_cmd *other = &parser->clist[entry->aidx - 1];
+    if (entry->hash == hash && other->nlen == cmd->nlen &&
+        arg_name_eq(other->name, cmd->name, cmd->nlen)) {
+      return;
+    }
+  }
+}
+
+/**\return index of subcommand with given name (not normalized) or -1 if not
+ * found
+ */
+inline int arg_parser_find_cmd(const arg_parser *parser, const char *name) {
+  if (parser->ctcap == 0) {
+    return -1;
+  }
+
+  unsigned len  = strlen(name);
+  unsigned hash = arg_name_hash(name, len);
+  unsigned mask = parser->ctcap - 1;
+  for (unsigned i = hash & mask;; i = (i + 1) & mask) {
+    const arg_hentry *entry = &parser->ctable[i];
+    if (entry->aidx == 0) {
+      return -1;
+    }
+
+    const arg_cmd *cmd = &parser->clist[entry->aidx - 1];
+    if (entry->hash == hash && cmd->nlen == len &&
+        arg_name_eq(cmd->name, name, len)) {
+      return entry->aidx - 1;
+    }
+  }
+}
+
+/**\return child of node with given symbol or 0 if there is no such child
+ */
+inline unsigned
+arg_trie_child(const arg_parser *parser, unsigned node, char c) {
+  unsigned iter = parser->tlist[node].child;
+  while (iter && parser->tlist[iter].c < c) {
+    iter = parser->tlist[iter].next;
+  }
+  return iter && parser->tlist[iter].c == c ? iter : 0;
+}
+
+/**\brief insert normalized name to trie with given root
+ * \param idx index of arg or subcommand
+ * \note if same name already inserted, then the first one stays
+ */
+inline void arg_trie_insert(arg_parser *parser,
+                            unsigned    root,
+                            const char *name,
+                            unsigned    len,
+                            unsigned    idx) {
+  if (parser->tsize == 0) {
+    parser->tcap  = 64;
+    parser->tsize = ARG_TRIE_CMDS + 1;
+    parser->tlist = (arg_tnode *)arg_arena_alloc(&parser->arena,
+                                                 sizeof(arg_tnode) * 64);
+    memset(parser->tlist, 0, sizeof(arg_tnode) * parser->tsize);
+  }
+
+  unsigned node = root;
+  for (unsigned i = 0; i < len; ++i) {
+    unsigned prev = 0;
+    unsigned iter = parser->tlist[node].child;
+    while (iter && parser->tlist[iter].c < name[i]) {
+      prev = iter;
+      iter = parser->tlist[iter].next;
+    }
+    if (iter && parser->tlist[iter].c == name[i]) {
+      node = iter;
+      continue;
+    }
+
+    if (parser->tsize == parser->tcap) {
+      parser->tlist = (arg_tnode *)arg_arena_grow(&parser->arena,
+                                                  parser->tlist,
+                                                  sizeof(arg_tnode) *
+                                                      parser->tcap,
+                                                  sizeof(arg_tnode) *
+                                                      parser->tcap * 2);
+      parser->tcap *= 2;
+    }
+
+    // keep children sorted, so names are printed in order
+    arg_tnode new_node = {0, iter, 0, 0, name[i]};
+    unsigned  new_iter = parser->tsize++;
+
+    parser->tlist[new_iter] = new_node;
+    if (prev) {
+      parser->tlist[prev].next = new_iter;
+    } else {
+      parser->tlist[node].child = new_iter;
+    }
+    node = new_iter;
+  }
+
+  if (parser->tlist[node].aidx != 0) {
+    return;
+  }
+  parser->tlist[node].aidx = idx + 1;
+
+  node = root;
+  ++parser->tlist[node].count;
+  for (unsigned i = 0; i < len; ++i) {
+    node = arg_trie_child(parser, node, name[i]);
+    ++parser->tlist[node].count;
+  }
+}
+
+/**\return node of prefix (not normalized) in trie with given root or 0 if
+ * there are no names with the prefix
+ */
+inline unsigned arg_trie_find(const arg_parser *parser,
+                              unsigned          root,
+                              const char *      prefix,
+                              unsigned          len) {
+  unsigned node = parser->tsize ? root : 0;
+  for (unsigned i = 0; i < len && node; ++i) {
+    node = arg_trie_child(parser, node, arg_name_char(prefix[i]));
+  }
+  return node;
+}
+
+/**\brief print all names under node in order, flags with `--`
+ * \return count of printed names
+ */
+inline int arg_trie_print(const arg_parser *parser,
+                          unsigned          root,
+                          unsigned          node,
+                          FILE *            out) {
+  if (node == 0) {
+    return 0;
+  }
+
+  int count = 0;
+  if (parser->tlist[node].aidx) {
+    unsigned idx = parser->tlist[node].aidx - 1;
+    if (root == ARG_TRIE_ARGS) {
+      fprintf(out, "--%s\n", parser->alist[idx].name);
+    } else {
+      fprintf(out, "%s\n", parser->clist[idx].name);
+    }
+    ++count;
+  }
+  for (unsigned iter = parser->tlist[node].child; iter;
+       iter          = parser->tlist[iter].next) {
+    count += arg_trie_print(parser, root, iter, out);
+  }
+  return count;
+}
+
+/**\return index of the only arg with name started by given prefix (not
+ * normalized) or -1 if there are no such args or there are several of them
+ */
+inline int arg_parser_find_prefix(const arg_parser *parser,
+                                  const char *      name,
+                                  unsigned          len) {
+  unsigned node = len ? arg_trie_find(parser, ARG_TRIE_ARGS, name, len) : 0;
+  if (node == 0 || parser->tlist[node].count != 1) {
+    return -1;
+  }
+
+  // path to the only name has no branches
+  while (parser->tlist[node].aidx == 0) {
+    node = parser->tlist[node].child;
+  }
+  return parser->tlist[node].aidx - 1;
+}
+
+/**\brief add names under node in order until list of suggestions is full
+ */
+inline void arg_trie_collect(const arg_parser *parser,
+                             unsigned          node,
+                             arg_suggest *     state) {
+  if (parser->tlist[node].aidx && state->count < ARG_MAX_SUGGESTIONS) {
+    state->list[state->count++] = parser->tlist[node].aidx - 1;
+  }
+  for (unsigned iter = parser->tlist[node].child;
+       iter && state->count < ARG_MAX_SUGGESTIONS;
+       iter = parser->tlist[iter].next) {
+    arg_trie_collect(parser, iter, state);
+  }
+}
+
+/**\brief find names with least edit distance to unknown name. Row of
+ * distance matrix for node is computed from row of its parent, so common
+ * prefixes are compared once, and only cells in band of width 2 * dist are
+ * computed. Subtrees, where all cells of row exceed dist, are skipped
+ * \param depth depth of node, row of the node must be already computed
+ */
+inline void arg_trie_suggest(const arg_parser *parser,
+                             unsigned          node,
+                             unsigned          depth,
+                             arg_suggest *     state) {
+  unsigned  len = state->len;
+  unsigned *row = state->rows + depth * (len + 1);
+
+  if (parser->tlist[node].aidx && row[len] <= state->dist) {
+    if (row[len] < state->dist) {
+      state->dist  = row[len];
+      state->count = 0;
+    }
+    if (state->count < ARG_MAX_SUGGESTIONS) {
+      state->list[state->count++] = parser->tlist[node].aidx - 1;
+    }
+  }
+
+  for (unsigned iter = parser->tlist[node].child; iter;
+       iter          = parser->tlist[iter].next) {
+    unsigned *next = row + len + 1;
+    unsigned  lo   = depth + 1 > state->dist ? depth + 1 - state->dist : 1;
+    unsigned  hi   = depth + 1 + state->dist;
+    unsigned  min  = depth + 1;
+
+    next[0] = depth + 1;
+    for (unsigned j = 1; j <= len; ++j) {
+      if (j < lo || j > hi) {
+        next[j] = state->dist + 1; // out of band, too far anyway
+        continue;
+      }
+
+      char     c    = arg_name_char(state->name[j - 1]);
+      unsigned best = row[j - 1] + (c != parser->tlist[iter].c);
+      if (best > row[j] + 1) {
+        best = row[j] + 1;
+      }
+      if (best > next[j - 1] + 1) {
+        best = next[j - 1] + 1;
+      }
+      next[j] = best;
+      if (min > best) {
+        min = best;
+      }
+    }
+
+    if (min <= state->dist) {
+      arg_trie_suggest(parser, iter, depth + 1, state);
+    }
+  }
+}
+
+/**\brief write to buf hint for unknown long flag: names started by it or
+ * names with least edit distance to it
+ * \return count of suggested names
+ */
+inline unsigned arg_parser_suggest(const arg_parser *parser,
+                                   const char *      flag,
+                                   char *            buf,
+                                   unsigned          size) {
+  arg_suggest state;
+  unsigned    node = 0;
+  unsigned    used = 0;
+
+  buf[0]      = '\0';
+  state.name  = flag + 2;
+  state.len   = 0;
+  state.count = 0;
+  state.rows  = NULL;
+  if (flag[0] != '-' || flag[1] != '-' || parser->tsize == 0) {
+    return 0;
+  }
+  while (state.name[state.len] != '\0' && state.name[state.len] != '=') {
+    ++state.len;
+  }
+
+  node = arg_trie_find(parser, ARG_TRIE_ARGS, state.name, state.len);
+  if (state.len && node) {
+    arg_trie_collect(parser, node, &state);
+  } else if (state.len) {
+    // deeper rows can't be closer than dist
+    unsigned max_len = 0;
+    state.dist       = state.len < 4 ? 1 : 2;
+    for (unsigned i = 0; i < parser->asize; ++i) {
+      if (max_len < parser->alist[i].nlen) {
+        max_len = parser->alist[i].nlen;
+      }
+    }
+    // longer name can't be within dist of any name, so rows are bounded by
+    // names of the parser, not by length of the unknown name
+    if (state.len <= max_len + state.dist) {
+      state.rows = (unsigned *)malloc(sizeof(unsigned) * (state.len + 1) *
+                                      (state.len + state.dist + 2));
+    }
+    if (state.rows) {
+      for (unsigned j = 0; j <= state.len; ++j) {
+        state.rows[j] = j;
+      }
+      arg_trie_suggest(parser, ARG_TRIE_ARGS, 0, &state);
+      free(state.rows);
+    }
+  }
+
+  for (unsigned i = 0; i < state.count && used < size; ++i) {
+    used += snprintf(buf + used,
+                     size - used,
+                     "%s--%s",
+                     i ? ", " : ", did you mean ",
+                     parser->alist[state.list[i]].name);
+  }
+  if (state.count && used < size) {
+    snprintf(buf + used, size - used, "?");
+  }
+  return state.count;
+}
+
+inline int arg_parser_complete(arg_parser *parser,
+                               int         index,
+                               int         count,
+                               char *      words[],
+                               FILE *      out) {
+  const char *cur = index < count ? words[index] : "";
+  if (index < 1) {
+    return 0;
+  }
+
+  // find subcommand of completed word and skip values of flags
+  for (int i = 1; i < index && i < count; ++i) {
+    const char *val   = NULL;
+    unsigned    bools = 0;
+    if (words[i][0] != '-') {
+      int cmd = arg_parser_find_cmd(parser, words[i]);
+      if (cmd >= 0) {
+        parser = arg_parser_cmd_parser(parser, cmd);
+      }
+      continue;
+    }
+
+    int arg_iter = arg_parser_match(parser, words[i], &val, &bools);
+    if (arg_iter >= 0 && val == NULL &&
+        parser->alist[arg_iter].type != ArgBool) {
+      if (i + 1 == index) {
+        return 0; // value of flag expected
+      }
+      ++i;
+    }
+  }
+
+  if (cur[0] != '-') {
+    unsigned node = arg_trie_find(parser, ARG_TRIE_CMDS, cur, strlen(cur));
+    return arg_trie_print(parser, ARG_TRIE_CMDS, node, out);
+  }
+  if (cur[1] != '\0' && cur[1] != '-') {
+    return 0; // short flag is complete
+  }
+
+  const char *prefix = cur[1] == '-' ? cur + 2 : cur + 1;
+  if (strchr(prefix, '=')) {
+    return 0;
+  }
+  unsigned node = arg_trie_find(parser, ARG_TRIE_ARGS, prefix, strlen(prefix));
+  return arg_trie_print(parser, ARG_TRIE_ARGS, node, out);
+}
+
+/**\brief write name of program usable as shell function name
+ */
+inline void arg_script_name(const char *prog, FILE *out) {
+  for (; *prog; ++prog) {
+    fputc(isalnum((unsigned char)*prog) ? *prog : '_', out);
+  }
+}
+
+inline int
+arg_complete_script(const char *prog, enum ArgShell shell, FILE *out) {
+  switch (shell) {
+  case ArgShellBash:
+    fputs("_", out);
+    arg_script_name(prog, out);
+    fputs("_complete() {\n"
+          "  local IFS=$'\\n'\n"
+          "  COMPREPLY=($(\"${COMP_WORDS[0]}\" " ARG_COMPLETE_FLAG
+          " \"$COMP_CWORD\" \"${COMP_WORDS[@]}\" 2>/dev/null))\n"
+          "}\n"
+          "complete -o default -F _",
+          out);
+    arg_script_name(prog, out);
+    fprintf(out, "_complete %s\n", prog);
+    break;
+  case ArgShellZsh:
+    fprintf(out, "#compdef %s\n_", prog);
+    arg_script_name(prog, out);
+    fputs("_complete() {\n"
+          "  local -a matches\n"
+          "  matches=(${(f)\"$(\"${words[1]}\" " ARG_COMPLETE_FLAG
+          " $((CURRENT - 1)) \"${words[@]}\" 2>/dev/null)\"})\n"
+          "  if (( ${#matches} )); then\n"
+          "    compadd -a matches\n"
+          "  else\n"
+          "    _files\n"
+          "  fi\n"
+          "}\n"
+          "compdef _",
+          out);
+    arg_script_name(prog, out);
+    fprintf(out, "_complete %s\n", prog);
+    break;
+  case ArgShellFish:
+    fprintf(out,
+            "complete -c %s -a '(%s " ARG_COMPLETE_FLAG
+            " (count (commandline -opc)) (commandline -opc)"
+            " (commandline -ct))'\n",
+            prog,
+            prog);
+    break;
+  default:
+    return 1;
+  }
+  return ferror(out);
+}
+
+/**\brief write value formatted for usage to buf
+ * \param buf buffer with space for any number, string values are not copied
+ * \param str set to formatted value: buf or string value
+ * \return length of formatted value
+ */
+inline unsigned arg_format_val(union ArgUnion val,
+                               enum ArgType   type,
+                               char *         buf,
+                               const char **  str) {
+  *str = buf;
+  switch (type) {
+  case ArgString:
+  case ArgIntList:
+  case ArgLongList:
+  case ArgLongLongList:
+  case ArgDoubleList:
+  case ArgStringList:
+    // defaults of list args are strings too
+    *str = val.val_str ? val.val_str : "";
+    return strlen(*str);
+  case ArgInt:
+    return snprintf(buf, ARG_MAX_NUM_LEN, "%i", val.val_int);
+  case ArgLong:
+    return snprintf(buf, ARG_MAX_NUM_LEN, "%li", val.val_long);
+  case ArgLongLong:
+    return snprintf(buf, ARG_MAX_NUM_LEN, "%lli", val.val_ll);
+  case ArgBool:
+    return snprintf(buf,
+                    ARG_MAX_NUM_LEN,
+                    "%s",
+                    val.val_bool ? "true" : "false");
+  case ArgDouble:
+    return snprintf(buf, ARG_MAX_NUM_LEN, "%f", val.val_double);
+  }
+  return 0;
+}
+
+/**\return width of column with flag in usage: `  -s, --name (=default)`
+ */
+inline unsigned arg_usage_width(const arg_desc *arg) {
+  char        buf[ARG_MAX_NUM_LEN];
+  const char *str   = NULL;
+  unsigned    width = 8 /*`  -s, --`*/ + arg->nlen;
+  if (arg->flgs & ArgDefault) {
+    width += 4 /*` (=)`*/ + arg_format_val(arg->dval, arg->type, buf, &str);
+  }
+  return width;
+}
+
+inline void arg_sink_put(arg_sink *sink, const char *str, size_t len) {
+  if (sink->cb) {
+    if (sink->status == 0) {
+      sink->status = sink->cb(sink->data, str, len);
+    }
+  } else if (sink->len + 1 < sink->size) {
+    size_t count = sink->size - sink->len - 1;
+    memcpy(sink->buf + sink->len, str, len < count ? len : count);
+  }
+  sink->len += len;
+}
+
+inline void arg_sink_pad(arg_sink *sink, size_t count) {
+  static const char spaces[] = "                                ";
+  for (; count > sizeof(spaces) - 1; count -= sizeof(spaces) - 1) {
+    arg_sink_put(sink, spaces, sizeof(spaces) - 1);
+  }
+  arg_sink_put(sink, spaces, count);
+}
+
+/**\brief render usage to sink by one pass, width of flags column is known
+ * from adding of args
+ */
+inline void arg_parser_render_usage(const arg_parser *parser, arg_sink *sink) {
+  char buf[ARG_MAX_NUM_LEN];
+
+  if (parser->mdesc[0] != '\0') {
+    arg_sink_put(sink, parser->mdesc, strlen(parser->mdesc));
+    arg_sink_put(sink, "\n", 1);
+  }
+
+  for (unsigned i = 0; i < parser->asize; ++i) {
+    const arg_desc *arg   = &parser->alist[i];
+    unsigned        width = 8 + arg->nlen;
+    if (arg->shrt) {
+      char shrt[] = {' ', ' ', '-', arg->shrt, ',', ' ', '-', '-'};
+      arg_sink_put(sink, shrt, sizeof(shrt));
+    } else {
+      arg_sink_put(sink, "      --", 8);
+    }
+    arg_sink_put(sink, arg->name, arg->nlen);
+
+    if (arg->flgs & ArgDefault) {
+      const char *val = NULL;
+      unsigned    len = arg_format_val(arg->dval, arg->type, buf, &val);
+      arg_sink_put(sink, " (=", 3);
+      arg_sink_put(sink, val, len);
+      arg_sink_put(sink, ")", 1);
+      width += 4 + len;
+    }
+
+    arg_sink_pad(sink, parser->ucol - width + 1);
+    arg_sink_put(sink, arg->desc, strlen(arg->desc));
+    arg_sink_put(sink, "\n", 1);
+  }
+
+  if (parser->csize != 0) {
+    arg_sink_put(sink, "commands:\n", 10);
+  }
+  for (unsigned i = 0; i < parser->csize; ++i) {
+    const arg_cmd *cmd = &parser->clist[i];
+    arg_sink_put(sink, "  ", 2);
+    arg_sink_put(sink, cmd->name, cmd->nlen);
+    arg_sink_pad(sink, parser->ucol - (2 + cmd->nlen) + 1);
+    arg_sink_put(sink, cmd->desc, strlen(cmd->desc));
+    arg_sink_put(sink, "\n", 1);
+  }
+
+  if (sink->cb == NULL && sink->size != 0) {
+    sink->buf[sink->len < sink->size ? sink->len : sink->size - 1] = '\0';
+  }
+}
+
+inline int arg_file_cb(void *file, const char *str, size_t len) {
+  return fwrite(str, 1, len, (FILE *)file) != len;
+}
+
+inline size_t
+arg_parser_usage_to(const arg_parser *parser, char *buf, size_t size) {
+  arg_sink sink = {NULL, NULL, buf, size, 0, 0};
+  arg_parser_render_usage(parser, &sink);
+  return sink.len;
+}
+
+inline int arg_parser_usage_write(const arg_parser *parser,
+                                  arg_usage_cb      callback,
+                                  void *            data) {
+  arg_sink sink = {callback, data, NULL, 0, 0, 0};
+  arg_parser_render_usage(parser, &sink);
+  return sink.status;
+}
+
+inline int arg_parser_usage_print(const arg_parser *parser, FILE *file) {
+  return arg_parser_usage_write(parser, arg_file_cb, file);
+}
+
+inline const char *arg_parser_usage_cached(arg_parser *parser) {
+  if (parser->usage == NULL) {
+    size_t len = arg_parser_usage_to(parser, NULL, 0);
+    char * buf = (char *)arg_arena_alloc(&parser->arena, len + 1);
+    arg_parser_usage_to(parser, buf, len + 1);
+    parser->usage = buf;
+    parser->ulen  = len;
+  }
+  return parser->usage;
+}
+
+inline char *arg_parser_usage(arg_parser *parser) {
+  const char *usage  = arg_parser_usage_cached(parser);
+  char *      retval = (char *)malloc(parser->ulen + 1);
+  memcpy(retval, usage, parser->ulen + 1);
+  return retval;
+}
+
+
+inline int arg_parser_add_arg(arg_parser *   parser,
+                              const char *   name,
+                              char           short_name,
+                              const char *   desc,
+                              enum ArgType   type,
+                              int            flags,
+                              union ArgUnion default_val) {
+  if (parser->asize == parser->acap) {
+    unsigned new_cap = parser->acap ? parser->acap * 2 : 16;
+
+    parser->alist = (arg_desc *)arg_arena_grow(&parser->arena,
+                                               parser->alist,
+                                               sizeof(arg_desc) * parser->acap,
+                                               sizeof(arg_desc) * new_cap);
+    parser->acap  = new_cap;
+  }
+
+  char *arg_name = arg_arena_strdup(&parser->arena, name);
+  for (char *iter = arg_name; *iter; ++iter) {
+    *iter = arg_name_char(*iter);
+  }
+
+  arg_desc arg = {arg_name,
+                 arg_arena_strdup(&parser->arena, desc),
+                 default_val,
+                 type,
+                 flags,
+                 short_name,
+                 (unsigned)strlen(arg_name)};
+
+  parser->alist[parser->asize] = arg;
+  parser->usage                = NULL;
+  if (parser->ucol < arg_usage_width(&arg)) {
+    parser->ucol = arg_usage_width(&arg);
+  }
+  arg_trie_insert(parser, ARG_TRIE_ARGS, arg.name, arg.nlen, parser->asize);
+  arg_parser_index_arg(parser, parser->asize++);
+  return parser->asize - 1;
+}
+
+inline int arg_parser_bind(arg_parser *parser, int handle, void *dst) {
+  if (dst == NULL || handle < 0 || (unsigned)handle >= parser->asize ||
+      arg_list_elem(parser->alist[handle].type) != parser->alist[handle].type) {
+    return -1;
+  }
+
+  for (unsigned i = 0; i < parser->bsize; ++i) {
+    if (parser->blist[i].handle == handle) {
+      parser->blist[i].dst = dst;
+      return 0;
+    }
+  }
+
+  if (parser->bsize == parser->bcap) {
+    unsigned new_cap = parser->bcap ? parser->bcap * 2 : 16;
+
+    parser->blist = (arg_bind *)arg_arena_grow(&parser->arena,
+                                               parser->blist,
+                                               sizeof(arg_bind) * parser->bcap,
+                                               sizeof(arg_bind) * new_cap);
+    parser->bcap  = new_cap;
+  }
+  parser->blist[parser->bsize].dst      = dst;
+  parser->blist[parser->bsize++].handle = handle;
+  return 0;
+}
+
+inline int arg_parser_add_bound(arg_parser *   parser,
+                                const char *   name,
+                                char           short_name,
+                                const char *   desc,
+                                enum ArgType   type,
+                                int            flags,
+                                union ArgUnion default_val,
+                                void *         dst) {
+  int handle = -1;
+  if (dst == NULL || arg_list_elem(type) != type) {
+    return -1;
+  }
+
+  handle = arg_parser_add_arg(parser,
+                              name,
+                              short_name,
+                              desc,
+                              type,
+                              flags,
+                              default_val);
+  if (arg_parser_bind(parser, handle, dst) != 0) {
+    return -1;
+  }
+  return handle;
+}
+
+inline void arg_result_write_bound(const arg_parser *parser,
+                                   const arg_result *res) {
+  for (unsigned i = 0; i < parser->bsize; ++i) {
+    const arg_bind *bind = &parser->blist[i];
+    const arg_slot *slot = arg_result_slot(parser, res, bind->handle);
+    if (slot == NULL || slot->count == 0) {
+      continue;
+    }
+
+    unsigned    size = arg_type_size(parser->alist[bind->handle].type);
+    const char *last = (const char *)slot->vals + size * (slot->count - 1);
+    memcpy(bind->dst, last, size);
+  }
+}
+
+inline int arg_parser_add_cmd(arg_parser *parser,
+                              const char *name,
+                              const char *desc,
+                              arg_cmd_cb  build,
+                              void *      data) {
+  if (parser->csize == parser->ccap) {
+    unsigned new_cap = parser->ccap ? parser->ccap * 2 : 16;
+
+    parser->clist = (arg_cmd *)arg_arena_grow(&parser->arena,
+                                              parser->clist,
+                                              sizeof(arg_cmd) * parser->ccap,
+                                              sizeof(arg_cmd) * new_cap);
+    parser->ccap  = new_cap;
+  }
+
+  char *cmd_name = arg_arena_strdup(&parser->arena, name);
+  for (char *iter = cmd_name; *iter; ++iter) {
+    *iter = arg_name_char(*iter);
+  }
+
+  arg_cmd cmd = {cmd_name,
+                 arg_arena_strdup(&parser->arena, desc),
+                 build,
+                 data,
+                 NULL,
+                 (unsigned)strlen(cmd_name)};
+
+  parser->clist[parser->csize] = cmd;
+  parser->usage                = NULL;
+  if (parser->ucol < 2 /*`  `*/ + cmd.nlen) {
+    parser->ucol = 2 + cmd.nlen;
+  }
+  arg_trie_insert(parser, ARG_TRIE_CMDS, cmd.name, cmd.nlen, parser->csize);
+  arg_parser_index_cmd(parser, parser->csize++);
+  return parser->csize - 1;
+}
+
+inline arg_parser *arg_parser_cmd_parser(arg_parser *parser, int cmd) {
+  if (cmd < 0 || (unsigned)cmd >= parser->csize) {
+    return NULL;
+  }
+
+  arg_cmd *iter = &parser->clist[cmd];
+  if (iter->parser == NULL) {
+    iter->parser = arg_parser_make(iter->desc);
+    arg_parser_set_opts(iter->parser, parser->opts & ~ArgParserResponseFiles);
+    if (iter->build) {
+      iter->build(iter->parser, iter->data);
+    }
+  }
+  return iter->parser;
+}
+
+inline int arg_parser_cmd(const arg_parser *parser) {
+  return arg_result_cmd(&parser->res, NULL);
+}
+
+inline int arg_result_cmd(const arg_result *res, int *pos) {
+  if (pos) {
+    *pos = res->cpos;
+  }
+  return res->cmd;
+}
+
+inline arg_parser *arg_parser_make(const char *main_desc) {
+  arg_arena   arena  = {NULL, NULL, 0};
+  arg_parser *retval = (arg_parser *)arg_arena_alloc(&arena, sizeof(*retval));
+  retval->alist      = NULL;
+  retval->asize      = 0;
+  retval->acap       = 0;
+  retval->htable     = NULL;
+  retval->hcap       = 0;
+  retval->opts       = ArgParserNone;
+  retval->ucol       = 0;
+  retval->usage      = NULL;
+  retval->ulen       = 0;
+  retval->etable     = NULL;
+  retval->ecap       = 0;
+  retval->eplen      = 0;
+  retval->clist      = NULL;
+  retval->csize      = 0;
+  retval->ccap       = 0;
+  retval->ctable     = NULL;
+  retval->ctcap      = 0;
+  retval->tlist      = NULL;
+  retval->tsize      = 0;
+  retval->tcap       = 0;
+  retval->blist      = NULL;
+  retval->bsize      = 0;
+  retval->bcap       = 0;
+  memset(retval->stable, 0, sizeof(retval->stable));
+  arg_result_init(&retval->res);
+  arg_result_init(&retval->fres);
+  retval->mdesc = arg_arena_strdup(&arena, main_desc);
+  retval->arena = arena;
+  return retval;
+}
+
+inline arg_parser *arg_parser_make_static(const char *    main_desc,
+                                          const arg_desc *list,
+                                          unsigned        size) {
+  arg_parser *retval = arg_parser_make(main_desc);
+  // list never changed by parser, it is copied to arena if arg will be added
+  retval->alist = (arg_desc *)list;
+  retval->asize = size;
+  retval->acap  = size;
+
+  for (unsigned i = 0; i < size; ++i) {
+    assert(list[i].nlen == strlen(list[i].name) && "key must be literal");
+    assert(arg_name_eq(list[i].name, list[i].name, list[i].nlen) &&
+           "name must be normalized");
+    arg_parser_index_arg(retval, i);
+    arg_trie_insert(retval, ARG_TRIE_ARGS, list[i].name, list[i].nlen, i);
+    if (retval->ucol < arg_usage_width(&list[i])) {
+      retval->ucol = arg_usage_width(&list[i]);
+    }
+  }
+  return retval;
+}
+
+inline void arg_parser_dispose(arg_parser *parser) {
+  for (unsigned i = 0; i < parser->csize; ++i) {
+    if (parser->clist[i].parser) {
+      arg_parser_dispose(parser->clist[i].parser);
+    }
+  }
+  arg_result_release(&parser->res);
+  arg_result_release(&parser->fres);
+
+  arg_arena arena = parser->arena;
+  arg_arena_release(&arena);
+}
+
+inline unsigned arg_parser_alloc_count(const arg_parser *parser) {
+  unsigned count = parser->arena.nallocs + parser->res.arena.nallocs +
+                   parser->fres.arena.nallocs;
+  for (unsigned i = 0; i < parser->csize; ++i) {
+    if (parser->clist[i].parser) {
+      count += arg_parser_alloc_count(parser->clist[i].parser);
+    }
+  }
+  return count;
+}
+
+inline void arg_result_init(arg_result *res) {
+  arg_arena arena = {NULL, NULL, 0};
+  res->arena      = arena;
+  res->slist      = NULL;
+  res->scap       = 0;
+  res->mlist      = NULL;
+  res->mblock     = NULL;
+  res->mused      = 0;
+  res->pending    = -1;
+  res->pflag      = NULL;
+  res->code       = 0;
+  res->err        = NULL;
+  res->cmd        = -1;
+  res->cpos       = 0;
+}
+
+/**\brief unmap files and release memory of result
+ * \note result itself can be placed in its arena
+ */
+inline void arg_result_release(arg_result *res) {
+#ifdef ARG_PARSER_POSIX
+  for (arg_mapping *iter = res->mlist; iter; iter = iter->prev) {
+    munmap(iter->addr, iter->size);
+  }
+#endif
+
+  arg_arena arena = res->arena;
+  arg_arena_release(&arena);
+}
+
+inline arg_result *arg_result_make(void) {
+  arg_arena   arena  = {NULL, NULL, 0};
+  arg_result *retval = (arg_result *)arg_arena_alloc(&arena, sizeof(*retval));
+  arg_result_init(retval);
+  retval->arena = arena;
+  return retval;
+}
+
+inline void arg_result_dispose(arg_result *res) {
+  arg_result_release(res);
+}
+
+inline void arg_parser_set_opts(arg_parser *parser, int opts) {
+  parser->opts = opts;
+}
+
+
+#define ARG_PARSER_ERROR(ret_ptr, err_buf, ...)                        \
+  if (ret_ptr) {                                                       \
+    int ret_count = snprintf(err_buf, ARG_MAX_ERROR_LEN, __VA_ARGS__); \
+    if (ret_count >= ARG_MAX_ERROR_LEN) {                              \
+      err_buf[ARG_MAX_ERROR_LEN - 1] = '\0';                           \
+      ret_count                      = ARG_MAX_ERROR_LEN;              \
+    }                                                                  \
+    *ret_ptr = (char *)malloc(ret_count + 1);                          \
+    strcpy(*ret_ptr, err_buf);                                         \
+  }
+
+inline int arg_parser_parse(arg_parser *parser,
+                            int *       argc,
+                            char **     argv[],
+                            bool        ignore_not_defined_flags,
+                            bool        remove_defined_flags_from_argv,
+                            char **     err) {
+  char      err_buf[ARG_MAX_ERROR_LEN];
+  long long index = 0;
+  if ((parser->opts & ArgParserCompletion) && *argc > 2 &&
+      strcmp((*argv)[1], ARG_COMPLETE_FLAG) == 0) {
+    const char *str = (*argv)[2];
+    if (arg_parse_ll(str, str + strlen(str), 0, INT_MAX, &index) == 0) {
+      arg_parser_complete(parser, index, *argc - 3, *argv + 3, stdout);
+    }
+    ARG_PARSER_ERROR(err, err_buf, "completion query answered");
+    return 6;
+  }
+
+  int pos    = 0;
+  int retval = arg_parser_parse_into(parser,
+                                     &parser->res,
+                                     argc,
+                                     argv,
+                                     ignore_not_defined_flags,
+                                     remove_defined_flags_from_argv,
+                                     err);
+  if (retval != 0) {
+    return retval;
+  }
+
+  arg_result_write_bound(parser, &parser->res);
+  int cmd = arg_result_cmd(&parser->res, &pos);
+  if (cmd < 0) {
+    return retval;
+  }
+
+  // subcommand is program name for its parser
+  arg_parser *sub      = arg_parser_cmd_parser(parser, cmd);
+  int         sub_argc = *argc - pos;
+  char **     sub_argv = *argv + pos;
+
+  retval = arg_parser_parse(sub,
+                            &sub_argc,
+                            &sub_argv,
+                            ignore_not_defined_flags,
+                            remove_defined_flags_from_argv,
+                            err);
+  if (remove_defined_flags_from_argv) {
+    *argc = pos + sub_argc;
+  }
+  return retval;
+}
+
+inline int
+arg_parser_parse_into(const arg_parser *parser,
+                      arg_result *      res,
+                      int *             argc,
+                      char **           argv[],
+                      bool              ignore_not_defined_flags,
+                      bool              remove_defined_flags_from_argv,
+                      char **           err) {
+  return arg_parser_parse_args(parser,
+                               res,
+                               argc,
+                               argv,
+                               ignore_not_defined_flags,
+                               remove_defined_flags_from_argv,
+                               NULL,
+                               0,
+                               NULL,
+                               err);
+}
+
+inline int arg_parser_parse_kept(const arg_parser *parser,
+                                 arg_result *      res,
+                                 int *             argc,
+                                 char **           argv[],
+                                 bool              ignore_not_defined_flags,
+                                 int *             kept,
+                                 int               kept_size,
+                                 int *             kept_count,
+                                 char **           err) {
+  return arg_parser_parse_args(parser,
+                               res,
+                               argc,
+                               argv,
+                               ignore_not_defined_flags,
+                               false,
+                               kept,
+                               kept_size,
+                               kept_count,
+                               err);
+}
+
+/**\brief parse args, args which stay in argv (program name and positional
+ * args) are moved to begin of argv by one pass if
+ * remove_defined_flags_from_argv set, and their indices written to kept if it
+ * is not NULL, but not more than kept_size
+ */
+inline int
+arg_parser_parse_args(const arg_parser *parser,
+                      arg_result *      res,
+                      int *             argc,
+                      char **           argv[],
+                      bool              ignore_not_defined_flags,
+                      bool              remove_defined_flags_from_argv,
+                      int *             kept,
+                      int               kept_size,
+                      int *             kept_count,
+                      char **           err) {
+  char            err_buf[ARG_MAX_ERROR_LEN];
+  char            hint[ARG_MAX_HINT_LEN];
+  const arg_desc *arg     = NULL;
+  const char *    flag    = NULL;
+  const char *    retval  = NULL;
+  int             write   = 0; // count of kept args
+  bool            cycle   = false;
+
+  arg_result_reset(parser, res);
+  if (parser->opts & ArgParserResponseFiles) {
+    flag = arg_result_expand(res, argc, argv, &cycle);
+    if (flag) {
+      goto ResponseFileError;
+    }
+  }
+
+  if (kept == NULL) {
+    kept_size = 0;
+  }
+  if (*argc > 0) {
+    if (kept_size > 0) {
+      kept[0] = 0; // program name
+    }
+    write = 1;
+  }
+
+  for (int val_iter = 1; val_iter < *argc; ++val_iter) {
+    flag    = (*argv)[val_iter];
+    int cmd = flag[0] != '-' ? arg_parser_find_cmd(parser, flag) : -1;
+    if (cmd >= 0) {
+      // subcommand and rest of args are kept for parser of subcommand
+      res->cmd  = cmd;
+      res->cpos = remove_defined_flags_from_argv ? write : val_iter;
+      for (; val_iter < *argc; ++val_iter, ++write) {
+        if (remove_defined_flags_from_argv) {
+          (*argv)[write] = (*argv)[val_iter];
+        }
+        if (write < kept_size) {
+          kept[write] = val_iter;
+        }
+      }
+      break;
+    }
+
+    if (flag[0] != '-') {
+      // positional arg, write cursor never overtakes read cursor
+      if (remove_defined_flags_from_argv) {
+        (*argv)[write] = (*argv)[val_iter];
+      }
+      if (write < kept_size) {
+        kept[write] = val_iter;
+      }
+      ++write;
+      continue;
+    }
+
+
+    unsigned bools    = 0;
+    int      arg_iter = arg_parser_match(parser, flag, &retval, &bools);
+    if (arg_iter < 0) {
+      if (ignore_not_defined_flags == false) {
+        goto NotDefinedFlagFound;
+      }
+      continue;
+    }
+    arg_result_store_bools(parser, res, flag, bools);
+
+    arg = &parser->alist[arg_iter];
+    if (retval == NULL && val_iter == *argc - 1 && arg->type != ArgBool) {
+      goto NoValueForFlag;
+    }
+
+    if (retval != NULL) {
+      // value set after `=` symbol
+    } else if (arg->type != ArgBool) {
+      retval = (*argv)[++val_iter];
+    } else {
+      if (val_iter == *argc - 1 || (*argv)[val_iter + 1][0] == '-' ||
+          arg_parser_find_cmd(parser, (*argv)[val_iter + 1]) >= 0) {
+        retval = "true";
+      } else {
+        retval = (*argv)[++val_iter];
+      }
+    }
+
+    if (arg_result_store(parser, res, arg_iter, retval) != 0) {
+      goto ConversionError;
+    }
+  }
+
+  if (remove_defined_flags_from_argv) {
+    *argc = write;
+  }
+  if (kept_count) {
+    *kept_count = write;
+  }
+
+  return arg_result_finalize(parser, res, err);
+
+NoValueForFlag:
+  ARG_PARSER_ERROR(err, err_buf, "no value for %s", flag);
+  return 1;
+
+NotDefinedFlagFound:
+  if (err) {
+    arg_parser_suggest(parser, flag, hint, sizeof(hint));
+  }
+  ARG_PARSER_ERROR(err, err_buf, "unknown flag: %s%s", flag, hint);
+  return 2;
+
+ConversionError:
+  ARG_PARSER_ERROR(err, err_buf, "can't convert: %s %s", flag, retval);
+  return 4;
+
+ResponseFileError:
+  if (cycle) {
+    ARG_PARSER_ERROR(err, err_buf, "recursive response file: %s", flag);
+    return 5;
+  }
+  ARG_PARSER_ERROR(err, err_buf, "can't read file: %s", flag);
+  return 5;
+}
+
+inline void arg_parser_reset(arg_parser *parser) {
+  arg_result_reset(parser, &parser->res);
+}
+
+inline void arg_result_reset(const arg_parser *parser, arg_result *res) {
+#ifdef ARG_PARSER_POSIX
+  for (arg_mapping *iter = res->mlist; iter; iter = iter->prev) {
+    munmap(iter->addr, iter->size);
   }
+#endif
+  res->mlist = NULL;
 
-  if (val_len > arg_len + 2 && val_for_comp[arg_len + 2] != '=') {
-    return 3;
+  // values, copies of args and expanded argv of previous parsing are placed
+  // after slots, so memory is reused by every parsing
+  if (res->mblock) {
+    arg_arena_rewind(&res->arena, res->mblock, res->mused);
+  }
+  arg_result_fit(parser, res);
+  for (unsigned arg_iter = 0; arg_iter < res->scap; ++arg_iter) {
+    arg_slot *slot = &res->slist[arg_iter];
+    slot->vals     = NULL;
+    slot->lens     = NULL;
+    slot->count    = 0;
+    slot->cap      = 0;
+    slot->seen     = false;
   }
+  arg_arena_reserve(&res->arena, ARG_ARENA_BLOCK_SIZE);
+  res->mblock  = res->arena.head;
+  res->mused   = res->arena.head->used;
+  res->pending = -1;
+  res->cmd     = -1;
+  res->cpos    = 0;
+}
 
-  if (str_arg_cmp(arg_name, val_for_comp + 2) != 0) {
-    return 4;
+/**\brief add empty slots for args added to parser after last parsing
+ */
+inline void arg_result_fit(const arg_parser *parser, arg_result *res) {
+  if (res->scap < parser->asize) {
+    // slots and first value of every arg
+    arg_arena_reserve(&res->arena,
+                      ARG_ARENA_ROUND(sizeof(arg_slot) * parser->asize) +
+                          ARG_ARENA_ALIGN * parser->asize);
+    res->slist = (arg_slot *)arg_arena_grow(&res->arena,
+                                            res->slist,
+                                            sizeof(arg_slot) * res->scap,
+                                            sizeof(arg_slot) * parser->asize);
+    memset(res->slist + res->scap,
+           0,
+           sizeof(arg_slot) * (parser->asize - res->scap));
+    res->scap = parser->asize;
   }
+}
 
+inline int arg_parser_parse_batch(arg_parser *        parser,
+                                  int                 count,
+                                  const int *         argcs,
+                                  char **const *      argvs,
+                                  bool                ignore_not_defined_flags,
+                                  arg_parser_batch_cb callback,
+                                  void *              data) {
+  for (int i = 0; i < count; ++i) {
+    int    argc   = argcs[i];
+    char **argv   = argvs[i];
+    int    result = arg_parser_parse(parser,
+                                  &argc,
+                                  &argv,
+                                  ignore_not_defined_flags,
+                                  false,
+                                  NULL);
+    int    status = callback(parser, i, result, data);
+    if (status != 0) {
+      return status;
+    }
+  }
   return 0;
 }
 
-inline char *arg_parser_usage(arg_parser *parser) {
-  char **  list_fmt_args   = NULL;
-  char *   retval          = NULL;
-  unsigned count           = 0;
-  unsigned longest_fmt_arg = 0;
-  unsigned desc_len        = 0;
-  unsigned usage_len       = 0;
-  unsigned retval_len      = 0;
-  unsigned offset          = 0;
-
-  list_fmt_args = (char **)malloc(sizeof(char *) * parser->asize);
-  for (unsigned i = 0; i < parser->asize; ++i) {
-    list_fmt_args[i] = (char *)malloc(ARG_MAX_FMT_ARG_LEN);
+inline int arg_parser_parse_many(const arg_parser *parser,
+                                 int               count,
+                                 const int *       argcs,
+                                 char **const *    argvs,
+                                 arg_result *      results,
+                                 int               nthreads) {
+#ifdef ARG_PARSER_THREADS
+  if (nthreads < 1) {
+    nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  }
+#else
+  // only calling worker runs, so it must own all jobs
+  nthreads = 1;
+#endif
+  if (nthreads > count) {
+    nthreads = count;
+  }
+  if (nthreads < 1) {
+    nthreads = 1;
   }
 
-  for (unsigned i = 0; i < parser->asize; ++i) {
-    arg_desc *  arg      = &parser->alist[i];
-    const char *arg_name = arg->name;
-    if (parser->alist[i].shrt && arg->flgs & ArgDefault) {
-      char *arg_def = val_to_string(arg->dval, arg->type);
-      count         = snprintf(list_fmt_args[i],
-                       ARG_MAX_FMT_ARG_LEN,
-                       "  -%c, --%s (=%s)",
-                       arg->shrt,
-                       arg_name,
-                       arg_def);
-      free(arg_def);
-    } else if (arg->flgs & ArgDefault) {
-      char *arg_def = val_to_string(arg->dval, arg->type);
-      count         = snprintf(list_fmt_args[i],
-                       ARG_MAX_FMT_ARG_LEN,
-                       "      --%s (=%s)",
-                       arg_name,
-                       arg_def);
-      free(arg_def);
-    } else if (parser->alist[i].shrt) {
-      count = snprintf(list_fmt_args[i],
-                       ARG_MAX_FMT_ARG_LEN,
-                       "  -%c, --%s",
-                       arg->shrt,
-                       arg_name);
-    } else {
-      count = snprintf(list_fmt_args[i],
-                       ARG_MAX_FMT_ARG_LEN,
-                       "      --%s",
-                       arg_name);
+  arg_pool    pool;
+  arg_worker  single;
+  arg_worker *workers = &single;
+  if (nthreads > 1) {
+    workers = (arg_worker *)malloc(sizeof(arg_worker) * nthreads);
+    if (workers == NULL) {
+      // parse all jobs in calling thread
+      workers  = &single;
+      nthreads = 1;
     }
+  }
+  pool.parser  = parser;
+  pool.argcs   = argcs;
+  pool.argvs   = argvs;
+  pool.results = results;
+  pool.workers = workers;
+  pool.size    = nthreads;
+
+  // every worker starts from own contiguous range of jobs
+  for (int i = 0; i < nthreads; ++i) {
+    workers[i].pool  = &pool;
+    workers[i].begin = (int)((long long)count * i / nthreads);
+    workers[i].end   = (int)((long long)count * (i + 1) / nthreads);
+#ifdef ARG_PARSER_THREADS
+    pthread_mutex_init(&workers[i].lock, NULL);
+#endif
+  }
 
-    if (count >= ARG_MAX_FMT_ARG_LEN) {
-      list_fmt_args[i][ARG_MAX_FMT_ARG_LEN - 1] = '\0';
+#ifdef ARG_PARSER_THREADS
+  int started = 1;
+  for (; started < nthreads; ++started) {
+    if (pthread_create(&workers[started].thread,
+                       NULL,
+                       arg_pool_run,
+                       &workers[started]) != 0) {
+      break; // jobs of not started workers will be stolen
     }
   }
+  arg_pool_run(&workers[0]);
+  for (int i = 1; i < started; ++i) {
+    pthread_join(workers[i].thread, NULL);
+  }
+  for (int i = 0; i < nthreads; ++i) {
+    pthread_mutex_destroy(&workers[i].lock);
+  }
+#else
+  arg_pool_run(&workers[0]);
+#endif
+  if (workers != &single) {
+    free(workers);
+  }
 
+  int failed = 0;
+  for (int i = 0; i < count; ++i) {
+    failed += results[i].code != 0;
+  }
+  return failed;
+}
 
-  for (unsigned i = 0; i < parser->asize; ++i) {
-    count = strlen(list_fmt_args[i]);
-    if (longest_fmt_arg < count) {
-      longest_fmt_arg = count;
-    }
+/**\brief take next chunk of jobs from begin of range of the worker
+ * \return non zero if jobs were taken
+ */
+inline int arg_pool_take(arg_worker *worker, int *begin, int *end) {
+#ifdef ARG_PARSER_THREADS
+  pthread_mutex_lock(&worker->lock);
+#endif
+  *begin = worker->begin;
+  *end   = worker->end;
+  if (*end - *begin > ARG_MANY_CHUNK) {
+    *end = *begin + ARG_MANY_CHUNK;
+  }
+  worker->begin = *end;
+#ifdef ARG_PARSER_THREADS
+  pthread_mutex_unlock(&worker->lock);
+#endif
+  return *begin < *end;
+}
 
-    desc_len += strlen(parser->alist[i].desc);
+/**\brief move second half of remaining jobs of some other worker to range of
+ * given worker
+ * \return non zero if jobs were stolen
+ */
+inline int arg_pool_steal(arg_worker *worker) {
+#ifdef ARG_PARSER_THREADS
+  arg_pool *pool = worker->pool;
+  int       self = (int)(worker - pool->workers);
+  for (int i = 1; i < pool->size; ++i) {
+    arg_worker *victim = &pool->workers[(self + i) % pool->size];
+    int         begin  = 0;
+    int         end    = 0;
+    pthread_mutex_lock(&victim->lock);
+    if (victim->end > victim->begin) {
+      begin       = victim->end - (victim->end - victim->begin + 1) / 2;
+      end         = victim->end;
+      victim->end = begin;
+    }
+    pthread_mutex_unlock(&victim->lock);
+
+    if (begin < end) {
+      pthread_mutex_lock(&worker->lock);
+      worker->begin = begin;
+      worker->end   = end;
+      pthread_mutex_unlock(&worker->lock);
+      return 1;
+    }
   }
+#else
+  (void)worker;
+#endif
+  return 0;
+}
 
-  usage_len  = strlen(parser->mdesc);
-  usage_len  = usage_len > 0 ? usage_len + 1 /*new line*/ : 0;
-  retval_len = usage_len + parser->asize * longest_fmt_arg +
-               parser->asize * 2 /*space and new line*/ + desc_len + 1 /*\0*/;
+/**\brief parse jobs of the worker, then steal jobs of other workers until all
+ * jobs are done
+ */
+inline void *arg_pool_run(void *worker) {
+  arg_worker *self  = (arg_worker *)worker;
+  arg_pool *  pool  = self->pool;
+  int         begin = 0;
+  int         end   = 0;
+  // stolen jobs are moved to range of the worker and taken by chunks too
+  while (arg_pool_take(self, &begin, &end) ||
+         (arg_pool_steal(self) && arg_pool_take(self, &begin, &end))) {
+    for (int i = begin; i < end; ++i) {
+      arg_result *res  = &pool->results[i];
+      int         argc = pool->argcs[i];
+      char **     argv = pool->argvs[i];
+      char *      err  = NULL;
+
+      res->code = arg_parser_parse_into(pool->parser,
+                                        res,
+                                        &argc,
+                                        &argv,
+                                        false,
+                                        false,
+                                        &err);
+      res->err  = NULL;
+      if (err) {
+        res->err = arg_arena_strdup(&res->arena, err);
+        free(err);
+      }
+    }
+  }
+  return NULL;
+}
 
-  retval                 = (char *)malloc(retval_len);
-  retval[retval_len - 1] = '\0';
+inline int arg_parser_feed(arg_parser *parser,
+                           const char *arg,
+                           bool        ignore_not_defined_flags,
+                           char **     err) {
+  return arg_parser_feed_into(parser,
+                              &parser->res,
+                              arg,
+                              ignore_not_defined_flags,
+                              err);
+}
 
+inline int arg_parser_feed_into(const arg_parser *parser,
+                                arg_result *      res,
+                                const char *      arg,
+                                bool              ignore_not_defined_flags,
+                                char **           err) {
+  char        err_buf[ARG_MAX_ERROR_LEN];
+  char        hint[ARG_MAX_HINT_LEN];
+  const char *flag     = arg;
+  const char *retval   = arg;
+  int         arg_iter = -1;
+  unsigned    bools    = 0;
+
+  arg_result_fit(parser, res);
+  if (res->pending >= 0) {
+    int pending  = res->pending;
+    res->pending = -1;
+    flag         = res->pflag;
+
+    if (parser->alist[pending].type != ArgBool || arg[0] != '-') {
+      if (parser->alist[pending].type == ArgString) {
+        retval = arg_arena_strdup(&res->arena, arg);
+      }
+      if (arg_result_store(parser, res, pending, retval) != 0) {
+        goto ConversionError;
+      }
+      return 0;
+    }
 
-  if (usage_len) {
-    offset +=
-        snprintf(retval + offset, retval_len - offset, "%s\n", parser->mdesc);
+    // bool flag without value
+    retval = "true";
+    arg_result_store(parser, res, pending, retval);
+    flag = arg;
   }
-  for (unsigned i = 0; i < parser->asize; ++i) {
-    count =
-        snprintf(retval + offset, retval_len - offset, "%s", list_fmt_args[i]);
 
-    memset(retval + offset + count, ' ', longest_fmt_arg - count);
-    offset += longest_fmt_arg;
+  if (arg[0] != '-') {
+    return 0; // positional arg, ignore
+  }
 
-    offset += snprintf(retval + offset,
-                       retval_len - offset,
-                       " %s\n",
-                       parser->alist[i].desc);
+  arg_iter = arg_parser_match(parser, arg, &retval, &bools);
+  if (arg_iter < 0) {
+    if (ignore_not_defined_flags) {
+      return 0;
+    }
+    goto NotDefinedFlagFound;
+  }
+  arg_result_store_bools(parser, res, arg, bools);
 
-    assert(count <= longest_fmt_arg && "wrong arg size calculation");
-    assert(offset < retval_len && "wrong complete size calculation");
+  if (retval == NULL) {
+    res->pending = arg_iter;
+    res->pflag   = arg_arena_strdup(&res->arena, arg);
+    return 0;
   }
 
+  if (parser->alist[arg_iter].type == ArgString) {
+    retval = arg_arena_strdup(&res->arena, retval);
+  }
+  if (arg_result_store(parser, res, arg_iter, retval) != 0) {
+    goto ConversionError;
+  }
+  return 0;
 
-  for (unsigned i = 0; i < parser->asize; ++i) {
-    free(list_fmt_args[i]);
+NotDefinedFlagFound:
+  if (err) {
+    arg_parser_suggest(parser, flag, hint, sizeof(hint));
   }
-  free(list_fmt_args);
+  ARG_PARSER_ERROR(err, err_buf, "unknown flag: %s%s", flag, hint);
+  return 2;
 
+ConversionError:
+  ARG_PARSER_ERROR(err, err_buf, "can't convert: %s %s", flag, retval);
+  return 4;
+}
 
+inline int arg_parser_finish(arg_parser *parser, char **err) {
+  int retval = arg_parser_finish_into(parser, &parser->res, err);
+  if (retval == 0) {
+    arg_result_write_bound(parser, &parser->res);
+  }
   return retval;
 }
 
-
-inline void arg_parser_add_arg(arg_parser *   parser,
-                               const char *   name,
-                               char           short_name,
-                               const char *   desc,
-                               enum ArgType   type,
-                               int            flags,
-                               union ArgUnion default_val) {
-  parser->alist =
-      (arg_desc *)realloc(parser->alist, sizeof(arg_desc) * ++parser->asize);
-
-  char *desc_copy;
-  if (desc) {
-    desc_copy = (char *)malloc(strlen(desc) + 1);
-    strcpy(desc_copy, desc);
-  } else {
-    desc_copy    = (char *)malloc(1);
-    desc_copy[0] = '\0';
+inline int
+arg_parser_finish_into(const arg_parser *parser, arg_result *res, char **err) {
+  char err_buf[ARG_MAX_ERROR_LEN];
+  int  pending = res->pending;
+  res->pending = -1;
+
+  arg_result_fit(parser, res);
+  if (pending >= 0) {
+    if (parser->alist[pending].type != ArgBool) {
+      ARG_PARSER_ERROR(err, err_buf, "no value for %s", res->pflag);
+      return 1;
+    }
+    arg_result_store(parser, res, pending, "true");
   }
 
-  arg_desc arg =
-      {str_to_arg_name(name), desc_copy, default_val, type, flags, short_name};
-
-  parser->alist[parser->asize - 1] = arg;
+  return arg_result_finalize(parser, res, err);
 }
 
-inline arg_parser *arg_parser_make(const char *main_desc) {
-  arg_parser *retval = (arg_parser *)malloc(sizeof(arg_parser));
-  retval->alist      = NULL;
-  retval->rlist      = NULL;
-  retval->asize      = 0;
-  retval->rsize      = 0;
-  if (main_desc) {
-    retval->mdesc = (char *)malloc(strlen(main_desc) + 1);
-    strcpy(retval->mdesc, main_desc);
-  } else {
-    retval->mdesc    = (char *)malloc(1);
-    retval->mdesc[0] = '\0';
+/**\brief convert value and append it to values of arg with given handle
+ * \return 0 in case of success, otherwise non zero value
+ */
+inline int arg_result_store(const arg_parser *parser,
+                            arg_result *      res,
+                            int               handle,
+                            const char *      str) {
+  union ArgUnion val;
+  enum ArgType   type = parser->alist[handle].type;
+  size_t         len  = strlen(str);
+  if (arg_list_elem(type) != type) {
+    return arg_result_store_list(parser, res, handle, str);
   }
-  return retval;
+  if (arg_val_from_range(type, str, str + len, &val) != 0) {
+    return 1;
+  }
+
+  arg_result_push_len(parser, res, handle, val, len);
+  return 0;
 }
 
-inline void arg_parser_dispose(arg_parser *parser) {
-  for (unsigned i = 0; i < parser->asize; ++i) {
-    free(parser->alist[i].name);
-    free(parser->alist[i].desc);
+/**\brief split value of list arg by ARG_LIST_SEP, convert and append values
+ * to array of the arg, which grows once for all values
+ * \return 0 in case of success, otherwise non zero value
+ * \note strings are copied to result, empty value adds no values, but
+ * the arg is found, so its default isn't used and required arg is satisfied
+ */
+inline int arg_result_store_list(const arg_parser *parser,
+                                 arg_result *      res,
+                                 int               handle,
+                                 const char *      str) {
+  enum ArgType elem = arg_list_elem(parser->alist[handle].type);
+  size_t       len  = strlen(str);
+  const char * end  = str + len;
+
+  res->slist[handle].seen = true;
+  if (len == 0) {
+    return 0;
   }
-  free(parser->mdesc);
-  free(parser->alist);
-  free(parser->rlist);
-  parser->mdesc = 0;
-  parser->alist = NULL;
-  parser->rlist = NULL;
-  parser->asize = 0;
-  parser->rsize = 0;
 
-  free(parser);
-}
+  if (elem == ArgString) {
+    char *copy = (char *)arg_arena_alloc(&res->arena, len + 1);
+    memcpy(copy, str, len + 1);
+    str = copy;
+    end = copy + len;
+  }
 
+  arg_result_reserve(parser,
+                     res,
+                     handle,
+                     res->slist[handle].count + arg_count_sep(str, end) + 1);
+  for (;;) {
+    union ArgUnion val;
+    const char *   sep = arg_find_sep(str, end);
+    if (elem == ArgString) {
+      *(char *)sep = '\0'; // copy is terminated by `\0` too
+    }
+    if (arg_val_from_range(elem, str, sep, &val) != 0) {
+      return 1;
+    }
+    arg_result_push_len(parser, res, handle, val, sep - str);
 
-#define ARG_PARSER_ERROR(ret_ptr, err_buf, ...)                        \
-  if (ret_ptr) {                                                       \
-    int ret_count = snprintf(err_buf, ARG_MAX_ERROR_LEN, __VA_ARGS__); \
-    if (ret_count >= ARG_MAX_ERROR_LEN) {                              \
-      err_buf[ARG_MAX_ERROR_LEN - 1] = '\0';                           \
-      ret_count                      = ARG_MAX_ERROR_LEN;              \
-    }                                                                  \
-    *ret_ptr = (char *)malloc(ret_count + 1);                          \
-    strcpy(*ret_ptr, err_buf);                                         \
+    if (sep == end) {
+      return 0;
+    }
+    str = sep + 1;
   }
+}
 
-inline int arg_parser_parse(arg_parser *parser,
-                            int *       argc,
-                            char **     argv[],
-                            bool        ignore_not_defined_flags,
-                            bool        remove_defined_flags_from_argv,
-                            char **     err) {
-  char        err_buf[ARG_MAX_ERROR_LEN];
-  arg_desc *  arg     = NULL;
-  arg_rval *  val     = NULL;
-  const char *flag    = NULL;
-  const char *retval  = NULL;
-  char *      endval  = NULL;
-  int         counter = 0;
-
-  for (int val_iter = 1; val_iter < *argc; val_iter += counter) {
-    counter = 1;
-    flag    = (*argv)[val_iter];
-    if (flag[0] != '-') {
-      continue; // positional arg, ignore
+/**\brief add values from environment and default values for args, which
+ * were not found
+ * \return 0 in case of success, otherwise same error codes as
+ * arg_parser_parse returns
+ */
+inline int
+arg_result_finalize(const arg_parser *parser, arg_result *res, char **err) {
+  char err_buf[ARG_MAX_ERROR_LEN];
+  for (unsigned arg_iter = 0; arg_iter < parser->asize; ++arg_iter) {
+    const arg_desc *arg = &parser->alist[arg_iter];
+    if (res->slist[arg_iter].seen) {
+      continue;
     }
 
+    const arg_env * env  = arg_parser_find_env(parser, arg);
+    const arg_slot *file = arg_result_slot(parser, &parser->fres, arg_iter);
+    if (env) {
+      if (arg_result_store(parser, res, arg_iter, env->val) != 0) {
+        ARG_PARSER_ERROR(err,
+                         err_buf,
+                         "can't convert: %s %s",
+                         env->name,
+                         env->val);
+        return 4;
+      }
+    } else if (file && file->seen) {
+      res->slist[arg_iter].seen = true;
+      unsigned size = arg_type_size(arg->type);
+      for (unsigned i = 0; i < file->count; ++i) {
+        union ArgUnion val;
+        memcpy(&val, (const char *)file->vals + size * i, size);
+        arg_result_push_len(parser,
+                            res,
+                            arg_iter,
+                            val,
+                            file->lens ? file->lens[i] : 0);
+      }
+    } else if (arg->flgs & ArgDefault) {
+      // default of list arg is string with values
+      if (arg_list_elem(arg->type) == arg->type) {
+        arg_result_push_val(parser, res, arg_iter, arg->dval);
+      } else if (arg->dval.val_str &&
+                 arg_result_store(parser, res, arg_iter, arg->dval.val_str)) {
+        ARG_PARSER_ERROR(err,
+                         err_buf,
+                         "can't convert default: --%s %s",
+                         arg->name,
+                         arg->dval.val_str);
+        return 4;
+      }
+    } else if (arg->flgs & ArgRequired) {
+      ARG_PARSER_ERROR(err,
+                       err_buf,
+                       "can't find required flag: --%s",
+                       arg->name);
+      return 3;
+    }
+  }
+  return 0;
+}
 
-    bool found = false;
-    for (unsigned arg_iter = 0; arg_iter < parser->asize; ++arg_iter) {
-      arg = &parser->alist[arg_iter];
-      if (arg_name_cmp(arg->name, arg->shrt, flag) == 0) {
-        retval = strstr(flag, "=");
+/**\return variable for arg or NULL if arg can't be set by environment or
+ * there is no variable for it
+ */
+inline const arg_env *arg_parser_find_env(const arg_parser *parser,
+                                          const arg_desc *  arg) {
+  if (parser->ecap == 0 ||
+      ((arg->flgs & ArgEnv) == 0 && (parser->opts & ArgParserEnvAll) == 0)) {
+    return NULL;
+  }
 
-        if (retval == NULL && val_iter == *argc - 1 && arg->type != ArgBool) {
-          goto NoValueForFlag;
-        }
+  unsigned hash = arg_name_hash(arg->name, arg->nlen);
+  unsigned mask = parser->ecap - 1;
+  for (unsigned i = hash & mask;; i = (i + 1) & mask) {
+    const arg_env *env = &parser->etable[i];
+    if (env->nlen == 0) {
+      return NULL;
+    }
+    if (env->hash == hash && env->nlen == arg->nlen &&
+        arg_name_eq(arg->name, env->name + parser->eplen, arg->nlen)) {
+      return env;
+    }
+  }
+}
 
-        if (retval != NULL) {
-          ++retval; // ignore `=` symbol
-        } else if (arg->type != ArgBool) {
-          retval = (*argv)[val_iter + 1];
-          ++counter;
-        } else {
-          if (val_iter == *argc - 1 || (*argv)[val_iter + 1][0] == '-') {
-            retval = "true";
-          } else {
-            retval = (*argv)[val_iter + 1];
-            ++counter;
-          }
-        }
+inline void
+arg_parser_set_env(arg_parser *parser, const char *prefix, char **envp) {
+  size_t   plen  = strlen(prefix);
+  unsigned count = 0;
+  if (envp == NULL) {
+#if defined(ARG_PARSER_POSIX)
+    extern char **environ;
+    envp = environ;
+#elif defined(_WIN32)
+    envp = _environ;
+#endif
+  }
 
-        parser->rlist = (arg_rval *)realloc(parser->rlist,
-                                            sizeof(arg_rval) * ++parser->rsize);
-        val           = &parser->rlist[parser->rsize - 1];
-        val->name     = arg->name;
-        val->type     = arg->type;
-
-        switch (arg->type) {
-        case ArgString:
-          val->rval.val_str = retval;
-          break;
-        case ArgBool:
-          if (strcmp(retval, "true") == 0) {
-            val->rval.val_bool = true;
-          } else if (strcmp(retval, "false") == 0) {
-            val->rval.val_bool = false;
-          } else {
-            val->rval.val_bool = strtol(retval, &endval, 0);
-            if (endval != retval + strlen(retval)) {
-              goto ConversionError;
-            }
-          }
-          break;
-        case ArgInt:
-          val->rval.val_int = strtol(retval, &endval, 0);
-          if (endval != retval + strlen(retval)) {
-            goto ConversionError;
-          }
-          break;
-        case ArgLong:
-          val->rval.val_long = strtol(retval, &endval, 0);
-          if (endval != retval + strlen(retval)) {
-            goto ConversionError;
-          }
-          break;
-        case ArgLongLong:
-          val->rval.val_ll = strtoll(retval, &endval, 0);
-          if (endval != retval + strlen(retval)) {
-            goto ConversionError;
-          }
-          break;
-        case ArgDouble:
-          val->rval.val_double = strtod(retval, &endval);
-          if (endval != retval + strlen(retval)) {
-            goto ConversionError;
-          }
-          break;
-        }
+  for (char **iter = envp; iter && *iter; ++iter) {
+    count += strncmp(*iter, prefix, plen) == 0;
+  }
+
+  parser->ecap = 16;
+  while (parser->ecap < count * 2) {
+    parser->ecap *= 2;
+  }
+  parser->eplen  = plen;
+  parser->etable = (arg_env *)arg_arena_alloc(&parser->arena,
+                                              sizeof(arg_env) * parser->ecap);
+  memset(parser->etable, 0, sizeof(arg_env) * parser->ecap);
+
+  for (char **iter = envp; iter && *iter; ++iter) {
+    const char *eq = strchr(*iter, '=');
+    if (strncmp(*iter, prefix, plen) != 0 || eq == NULL ||
+        eq == *iter + plen) {
+      continue;
+    }
 
-        found = true;
-        arg->flgs |= ArgFound;
+    // copy `NAME=value` and split it to name and value
+    char *   name = arg_arena_strdup(&parser->arena, *iter);
+    unsigned nlen = eq - *iter - plen;
+    unsigned hash = arg_name_hash(name + plen, nlen);
+    unsigned mask = parser->ecap - 1;
+
+    name[plen + nlen] = '\0';
+
+    for (unsigned i = hash & mask;; i = (i + 1) & mask) {
+      arg_env *env = &parser->etable[i];
+      if (env->nlen == 0) {
+        env->hash = hash;
+        env->nlen = nlen;
+        env->name = name;
+        env->val  = name + plen + nlen + 1;
         break;
       }
+      if (env->hash == hash && env->nlen == nlen &&
+          strncmp(env->name + plen, name + plen, nlen) == 0) {
+        break; // first variable with same name stays, as for getenv
+      }
     }
+  }
+}
 
-    if (found == false && ignore_not_defined_flags == false) {
-      goto NotDefinedFlagFound;
+/**\brief split next not empty and not comment line of config in place
+ * \param iter current position, moved to start of next line
+ * \param val set to value or NULL if line has no `=`
+ * \return key or NULL if there are no more lines
+ */
+inline char *arg_next_line(char **iter, char *end, char **val) {
+  while (*iter < end) {
+    char *line = *iter;
+    char *eol  = (char *)memchr(line, '\n', end - line);
+    eol        = eol ? eol : end;
+    *iter      = eol < end ? eol + 1 : end;
+
+    while (line < eol && arg_is_space(*line)) {
+      ++line;
+    }
+    if (line == eol || *line == '#') {
+      continue;
     }
 
-    if (remove_defined_flags_from_argv) {
-      for (int i = val_iter; i < (*argc - counter); ++i) {
-        (*argv)[i] = (*argv)[i + counter];
+    char *key_end = (char *)memchr(line, '=', eol - line);
+    char *val_end = eol;
+    *val          = NULL;
+    if (key_end) {
+      *val = key_end + 1;
+      while (*val < val_end && arg_is_space(**val)) {
+        ++*val;
+      }
+      while (val_end > *val && arg_is_space(val_end[-1])) {
+        --val_end;
       }
-      (*argc) -= counter;
-      counter = 0;
+      if (val_end - *val >= 2 && (**val == '"' || **val == '\'') &&
+          val_end[-1] == **val) {
+        ++*val;
+        --val_end;
+      }
+      *val_end = '\0';
+    } else {
+      key_end = eol;
+    }
+
+    while (key_end > line && arg_is_space(key_end[-1])) {
+      --key_end;
     }
+    *key_end = '\0';
+    return line;
   }
+  return NULL;
+}
 
-  for (unsigned arg_iter = 0; arg_iter < parser->asize; ++arg_iter) {
-    arg = &parser->alist[arg_iter];
-    if ((arg->flgs & ArgFound) == 0) {
-      if (arg->flgs & ArgDefault) {
-        parser->rlist = (arg_rval *)realloc(parser->rlist,
-                                            sizeof(arg_rval) * ++parser->rsize);
-        parser->rlist[parser->rsize - 1].name = arg->name;
-        parser->rlist[parser->rsize - 1].type = arg->type;
-        parser->rlist[parser->rsize - 1].rval = arg->dval;
-      } else if (arg->flgs & ArgRequired) {
-        goto FlagNotFound;
+/**\brief drop values added after slots were saved
+ */
+inline void arg_result_restore_slots(arg_result *res, const arg_slot *saved) {
+  for (unsigned i = 0; i < res->scap; ++i) {
+    res->slist[i].count = saved[i].count;
+    res->slist[i].seen  = saved[i].seen;
+  }
+}
+
+inline int
+arg_parser_load_file(arg_parser *parser, const char *path, char **err) {
+  char        err_buf[ARG_MAX_ERROR_LEN];
+  size_t      size     = 0;
+  char *      iter     = arg_result_map_file(&parser->fres, path, &size, NULL);
+  char *      end      = NULL;
+  char *      val      = NULL;
+  const char *key      = NULL;
+  int         arg_iter = -1;
+  arg_slot *  saved    = NULL; // slots before the file
+
+  if (iter == NULL) {
+    goto FileError;
+  }
+  end = iter + size;
+
+  // values of failed file are dropped, so it doesn't change later parsing
+  arg_result_fit(parser, &parser->fres);
+  saved = (arg_slot *)arg_arena_alloc(&parser->fres.arena,
+                                      sizeof(arg_slot) * parser->fres.scap);
+  memcpy(saved, parser->fres.slist, sizeof(arg_slot) * parser->fres.scap);
+
+  while ((key = arg_next_line(&iter, end, &val)) != NULL) {
+    arg_iter = arg_parser_find(parser, key, strlen(key));
+    if (arg_iter < 0) {
+      goto UnknownKey;
+    }
+    if (val == NULL) {
+      if (parser->alist[arg_iter].type != ArgBool) {
+        goto NoValue;
       }
+      val = (char *)"true";
+    }
+    if (arg_result_store(parser, &parser->fres, arg_iter, val) != 0) {
+      goto ConversionError;
     }
   }
-
   return 0;
 
-NoValueForFlag:
-  ARG_PARSER_ERROR(err, err_buf, "no value for %s", flag);
+NoValue:
+  arg_result_restore_slots(&parser->fres, saved);
+  ARG_PARSER_ERROR(err, err_buf, "no value for %s in %s", key, path);
   return 1;
 
-NotDefinedFlagFound:
-  ARG_PARSER_ERROR(err, err_buf, "unknown flag: %s", flag);
+UnknownKey:
+  arg_result_restore_slots(&parser->fres, saved);
+  ARG_PARSER_ERROR(err, err_buf, "unknown key: %s in %s", key, path);
   return 2;
 
-FlagNotFound:
-  ARG_PARSER_ERROR(err, err_buf, "can't find required flag: --%s", arg->name);
-  return 3;
-
 ConversionError:
-  ARG_PARSER_ERROR(err, err_buf, "can't convert: %s %s", flag, retval);
+  arg_result_restore_slots(&parser->fres, saved);
+  ARG_PARSER_ERROR(err, err_buf, "can't convert: %s %s in %s", key, val, path);
   return 4;
+
+FileError:
+  ARG_PARSER_ERROR(err, err_buf, "can't read file: %s", path);
+  return 5;
+}
+
+inline int arg_parser_handle(const arg_parser *parser, const char *name) {
+  return arg_parser_find(parser, name, strlen(name));
 }
 
 inline int arg_parser_count(arg_parser *parser, const char *name) {
-  int      count    = 0;
-  unsigned name_len = strlen(name);
-  for (unsigned i = 0; i < parser->rsize; ++i) {
-    arg_rval *  arg      = &parser->rlist[i];
-    const char *arg_name = arg->name;
-    if (strlen(arg_name) == name_len && str_arg_cmp(arg_name, name) == 0) {
-      ++count;
-    }
-  }
+  return arg_result_count(parser, &parser->res, name);
+}
 
-  return count;
+inline int arg_parser_hcount(const arg_parser *parser, int handle) {
+  return arg_result_hcount(parser, &parser->res, handle);
 }
 
 inline int arg_parser_get_args(const arg_parser *parser,
@@ -825,41 +4647,223 @@ inline int arg_parser_get_args(const arg_parser *parser,
                                enum ArgType      type,
                                void *            val,
                                int               count) {
-  int      retval   = 0;
-  unsigned name_len = strlen(name);
-  for (unsigned i = 0; i < parser->rsize && retval < count; ++i) {
-    arg_rval *  arg      = &parser->rlist[i];
-    const char *arg_name = arg->name;
-    if (strlen(arg_name) == name_len && str_arg_cmp(arg_name, name) == 0) {
-      if (type != arg->type) {
-        return 1;
-      }
-      switch (type) {
-      case ArgString:
-        *((const char **)val + retval++) = arg->rval.val_str;
-        break;
-      case ArgBool:
-        *((bool *)val + retval++) = arg->rval.val_bool;
-        break;
-      case ArgInt:
-        *((int *)val + retval++) = arg->rval.val_int;
-        break;
-      case ArgLong:
-        *((long *)val + retval++) = arg->rval.val_long;
-        break;
-      case ArgLongLong:
-        *((long long *)val + retval++) = arg->rval.val_ll;
-        break;
-      case ArgDouble:
-        *((double *)val + retval++) = arg->rval.val_double;
-        break;
-      default:
-        assert(false && "unknown arg type");
-      }
-    }
+  return arg_result_get_args(parser, &parser->res, name, type, val, count);
+}
+
+inline int arg_parser_hget_args(const arg_parser *parser,
+                                int               handle,
+                                enum ArgType      type,
+                                void *            val,
+                                int               count) {
+  return arg_result_hget_args(parser, &parser->res, handle, type, val, count);
+}
+
+inline int arg_parser_hget_last(const arg_parser *parser,
+                                int               handle,
+                                enum ArgType      type,
+                                void *            val) {
+  return arg_result_hget_last(parser, &parser->res, handle, type, val);
+}
+
+inline const void *arg_parser_hget_list(const arg_parser *parser,
+                                        int               handle,
+                                        enum ArgType      type,
+                                        unsigned *        len) {
+  return arg_result_hget_list(parser, &parser->res, handle, type, len);
+}
+
+inline int arg_parser_hget_strn(const arg_parser *parser,
+                                int               handle,
+                                unsigned          index,
+                                const char **     str,
+                                size_t *          len) {
+  return arg_result_hget_strn(parser, &parser->res, handle, index, str, len);
+}
+
+/**\return slot of arg with given handle or NULL if handle is not valid or
+ * nothing was parsed into the result
+ */
+inline const arg_slot *
+arg_result_slot(const arg_parser *parser, const arg_result *res, int handle) {
+  if (handle < 0 || (unsigned)handle >= parser->asize ||
+      (unsigned)handle >= res->scap) {
+    return NULL;
   }
+  return &res->slist[handle];
+}
 
-  return retval;
+inline int arg_result_count(const arg_parser *parser,
+                            const arg_result *res,
+                            const char *      name) {
+  return arg_result_hcount(parser, res, arg_parser_handle(parser, name));
+}
+
+inline int arg_result_hcount(const arg_parser *parser,
+                             const arg_result *res,
+                             int               handle) {
+  const arg_slot *slot = arg_result_slot(parser, res, handle);
+  return slot ? (int)slot->count : 0;
+}
+
+inline int arg_result_get_args(const arg_parser *parser,
+                               const arg_result *res,
+                               const char *      name,
+                               enum ArgType      type,
+                               void *            val,
+                               int               count) {
+  return arg_result_hget_args(parser,
+                              res,
+                              arg_parser_handle(parser, name),
+                              type,
+                              val,
+                              count);
+}
+
+inline int arg_result_hget_args(const arg_parser *parser,
+                                const arg_result *res,
+                                int               handle,
+                                enum ArgType      type,
+                                void *            val,
+                                int               count) {
+  const arg_slot *slot = arg_result_slot(parser, res, handle);
+  if (slot == NULL) {
+    return 0;
+  }
+  if (type != parser->alist[handle].type) {
+    return -1;
+  }
+
+  if (count > (int)slot->count) {
+    count = slot->count;
+  }
+  if (count > 0) {
+    memcpy(val, slot->vals, arg_type_size(type) * count);
+  }
+
+  return count;
+}
+
+inline int arg_result_hget_last(const arg_parser *parser,
+                                const arg_result *res,
+                                int               handle,
+                                enum ArgType      type,
+                                void *            val) {
+  const arg_slot *slot = arg_result_slot(parser, res, handle);
+  if (slot == NULL) {
+    return 0;
+  }
+  if (type != parser->alist[handle].type) {
+    return -1;
+  }
+  if (slot->count == 0) {
+    return 0;
+  }
+
+  unsigned size = arg_type_size(type);
+  memcpy(val, (const char *)slot->vals + size * (slot->count - 1), size);
+  return 1;
+}
+
+inline const void *arg_result_hget_list(const arg_parser *parser,
+                                        const arg_result *res,
+                                        int               handle,
+                                        enum ArgType      type,
+                                        unsigned *        len) {
+  const arg_slot *slot = arg_result_slot(parser, res, handle);
+  *len                 = 0;
+  if (slot == NULL || slot->count == 0 || type != parser->alist[handle].type) {
+    return NULL;
+  }
+
+  *len = slot->count;
+  return slot->vals;
+}
+
+inline int arg_result_hget_strn(const arg_parser *parser,
+                                const arg_result *res,
+                                int               handle,
+                                unsigned          index,
+                                const char **     str,
+                                size_t *          len) {
+  const arg_slot *slot = arg_result_slot(parser, res, handle);
+  if (slot == NULL) {
+    return 0;
+  }
+  if (arg_list_elem(parser->alist[handle].type) != ArgString) {
+    return -1;
+  }
+  if (index >= slot->count) {
+    return 0;
+  }
+
+  *str = ((const char *const *)slot->vals)[index];
+  *len = slot->lens[index];
+  return 1;
+}
+
+/**\brief append value to values of arg with given handle
+ */
+inline void arg_result_push_val(const arg_parser *parser,
+                                arg_result *      res,
+                                int               handle,
+                                union ArgUnion    val) {
+  enum ArgType type = arg_list_elem(parser->alist[handle].type);
+  size_t       len  = 0;
+  if (type == ArgString && val.val_str) {
+    len = strlen(val.val_str);
+  }
+  arg_result_push_len(parser, res, handle, val, len);
+}
+
+/**\brief same as arg_result_push_val, but length of string value is known
+ */
+inline void arg_result_push_len(const arg_parser *parser,
+                                arg_result *      res,
+                                int               handle,
+                                union ArgUnion    val,
+                                size_t            len) {
+  arg_slot *slot = &res->slist[handle];
+  unsigned  size = arg_type_size(parser->alist[handle].type);
+  if (slot->count == slot->cap) {
+    arg_result_reserve(parser, res, handle, slot->count + 1);
+  }
+
+  if (slot->lens) {
+    slot->lens[slot->count] = len;
+  }
+  slot->seen = true;
+  // all members of the union start from its beginning
+  memcpy((char *)slot->vals + size * slot->count++, &val, size);
+}
+
+/**\brief grow array of values of arg with given handle to hold at least
+ * count values
+ */
+inline void arg_result_reserve(const arg_parser *parser,
+                               arg_result *      res,
+                               int               handle,
+                               unsigned          count) {
+  arg_slot *slot = &res->slist[handle];
+  unsigned  size = arg_type_size(parser->alist[handle].type);
+  if (count <= slot->cap) {
+    return;
+  }
+
+  unsigned new_cap = slot->cap ? slot->cap * 2 : 1;
+  if (new_cap < count) {
+    new_cap = count;
+  }
+  slot->vals = arg_arena_grow(&res->arena,
+                              slot->vals,
+                              size * slot->cap,
+                              size * new_cap);
+  if (arg_list_elem(parser->alist[handle].type) == ArgString) {
+    slot->lens = (size_t *)arg_arena_grow(&res->arena,
+                                          slot->lens,
+                                          sizeof(size_t) * slot->cap,
+                                          sizeof(size_t) * new_cap);
+  }
+  slot->cap = new_cap;
 }
 
 
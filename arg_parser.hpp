@@ -0,0 +1,957 @@
+/**\file
+ * C++17 front end over arg_parser.h
+ *
+ * - arg::spec - description of one flag with its c++ type
+ *
+ * - arg::schema - constexpr table of flags. Flag names are normalized (lower
+ * case and `-` instead of `_`), checked for duplicates and indexed by perfect
+ * hash at compile time
+ *
+ * - arg::static_parser - parses argv against the schema without any heap
+ * allocation
+ *
+ * - arg::hget_view - string values of arg_parser as std::string_view
+ *
+ * - arg::parser - owner of arg_parser, which returns arg::flag handles for
+ * added flags. Values are read by handle without name lookup
+ *
+ * - arg::field - member of user struct bound to flag, table of fields is
+ * written by arg::parser after every successfull parsing
+ *
+ *
+ * Usage:
+ *
+ * \code
+ * static constexpr auto cli = arg::make_schema(
+ *     arg::spec<bool>("help", 'h', "print usage info"),
+ *     arg::spec<int>("threads", 't', "count of threads").def(4),
+ *     arg::spec<const char *>("config", 0, "path to config").required());
+ *
+ * arg::static_parser<cli> parser;
+ * if (parser.parse(argc, argv) != 0) {
+ *   std::cerr << "fail parsing args: " << parser.error_flag() << std::endl;
+ * }
+ * int threads = parser.get<cli.index("threads")>();
+ * \endcode
+ *
+ * \code
+ * arg::parser parser("description");
+ * auto threads = parser.add(arg::spec<int>("threads", 't').def(4));
+ * auto ids     = parser.add_list(arg::spec<int>("ids", 'i'));
+ * if (parser.parse(argc, argv) != 0) {
+ *   std::cerr << parser.error() << std::endl;
+ * }
+ * int            threads_val = threads.value_or(1);
+ * arg::span<int> ids_vals    = ids.values();
+ * \endcode
+ *
+ * \code
+ * struct config {
+ *   int         threads = 1;
+ *   const char *path    = nullptr;
+ * };
+ *
+ * static constexpr auto fields = std::make_tuple(
+ *     arg::make_field(&config::threads, arg::spec<int>("threads", 't')),
+ *     arg::make_field(&config::path, arg::spec<const char *>("path", 0)));
+ *
+ * config      cfg;
+ * arg::parser parser;
+ * parser.bind(cfg, fields);
+ * parser.parse(argc, argv); // values are written to cfg
+ * \endcode
+ */
+
+#pragma once
+
+
+#include "arg_parser.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#endif
+
+
+namespace arg {
+
+template <typename T>
+struct type_of;
+
+template <>
+struct type_of<bool> {
+  static constexpr ArgType value = ArgBool;
+};
+
+template <>
+struct type_of<const char *> {
+  static constexpr ArgType value = ArgString;
+};
+
+template <>
+struct type_of<int> {
+  static constexpr ArgType value = ArgInt;
+};
+
+template <>
+struct type_of<long> {
+  static constexpr ArgType value = ArgLong;
+};
+
+template <>
+struct type_of<long long> {
+  static constexpr ArgType value = ArgLongLong;
+};
+
+template <>
+struct type_of<double> {
+  static constexpr ArgType value = ArgDouble;
+};
+
+
+/**\brief type of list arg with values of given c++ type
+ */
+template <typename T>
+struct list_of;
+
+template <>
+struct list_of<const char *> {
+  static constexpr ArgType value = ArgStringList;
+};
+
+template <>
+struct list_of<int> {
+  static constexpr ArgType value = ArgIntList;
+};
+
+template <>
+struct list_of<long> {
+  static constexpr ArgType value = ArgLongList;
+};
+
+template <>
+struct list_of<long long> {
+  static constexpr ArgType value = ArgLongLongList;
+};
+
+template <>
+struct list_of<double> {
+  static constexpr ArgType value = ArgDoubleList;
+};
+
+
+/**\return value of given type from the union
+ */
+template <typename T>
+constexpr T union_get(const ArgUnion &val) noexcept {
+  if constexpr (std::is_same_v<T, bool>) {
+    return val.val_bool;
+  } else if constexpr (std::is_same_v<T, const char *>) {
+    return val.val_str;
+  } else if constexpr (std::is_same_v<T, int>) {
+    return val.val_int;
+  } else if constexpr (std::is_same_v<T, long>) {
+    return val.val_long;
+  } else if constexpr (std::is_same_v<T, long long>) {
+    return val.val_ll;
+  } else {
+    return val.val_double;
+  }
+}
+
+
+/**\return union with given value
+ */
+template <typename T>
+ArgUnion union_make(T val) noexcept {
+  ArgUnion retval{};
+  if constexpr (std::is_same_v<T, bool>) {
+    retval.val_bool = val;
+  } else if constexpr (std::is_same_v<T, const char *>) {
+    retval.val_str = val;
+  } else if constexpr (std::is_same_v<T, int>) {
+    retval.val_int = val;
+  } else if constexpr (std::is_same_v<T, long>) {
+    retval.val_long = val;
+  } else if constexpr (std::is_same_v<T, long long>) {
+    retval.val_ll = val;
+  } else {
+    retval.val_double = val;
+  }
+  return retval;
+}
+
+
+/**\brief read only view of values, std::span if it is available
+ */
+#if __cplusplus >= 202002L && __has_include(<span>)
+template <typename T>
+using span = std::span<const T>;
+#else
+template <typename T>
+class span {
+public:
+  constexpr span() noexcept = default;
+  constexpr span(const T *data, std::size_t size) noexcept
+      : data_{data}
+      , size_{size} {
+  }
+
+  constexpr const T *data() const noexcept {
+    return data_;
+  }
+  constexpr std::size_t size() const noexcept {
+    return size_;
+  }
+  constexpr bool empty() const noexcept {
+    return size_ == 0;
+  }
+  constexpr const T *begin() const noexcept {
+    return data_;
+  }
+  constexpr const T *end() const noexcept {
+    return data_ + size_;
+  }
+  constexpr const T &operator[](std::size_t idx) const noexcept {
+    return data_[idx];
+  }
+  constexpr const T &back() const noexcept {
+    return data_[size_ - 1];
+  }
+
+private:
+  const T *   data_ = nullptr;
+  std::size_t size_ = 0;
+};
+#endif
+
+
+/**\return string value with given index as view, length is taken from
+ * parsing. Empty view if arg has no such value or isn't string (list)
+ */
+inline std::string_view hget_view(const arg_parser *parser,
+                                  const arg_result *res,
+                                  int               handle,
+                                  unsigned          index = 0) noexcept {
+  const char *str = nullptr;
+  std::size_t len = 0;
+  if (arg_result_hget_strn(parser, res, handle, index, &str, &len) != 1) {
+    return {};
+  }
+  return std::string_view(str, len);
+}
+
+inline std::string_view hget_view(const arg_parser *parser,
+                                  int               handle,
+                                  unsigned          index = 0) noexcept {
+  return hget_view(parser, &parser->res, handle, index);
+}
+
+
+/**\return symbol of normalized name, same as arg_name_char
+ */
+constexpr char name_char(char c) noexcept {
+  if (c == '_') {
+    return '-';
+  }
+  if (c >= 'A' && c <= 'Z') {
+    return c - 'A' + 'a';
+  }
+  return c;
+}
+
+/**\return true if names are equal after normalization
+ */
+constexpr bool name_eq(std::string_view lhs, std::string_view rhs) noexcept {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    if (name_char(lhs[i]) != name_char(rhs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**\return seeded hash of normalized name, used for perfect hash
+ */
+constexpr std::uint32_t name_hash(std::string_view name,
+                                  std::uint32_t    seed) noexcept {
+  std::uint32_t hash = 2166136261u ^ (seed * 0x9e3779b9u);
+  for (char c : name) {
+    hash ^= static_cast<unsigned char>(name_char(c));
+    hash *= 16777619u;
+  }
+  hash ^= hash >> 15;
+  hash *= 0x2c1b3c6du;
+  hash ^= hash >> 12;
+  return hash;
+}
+
+
+/**\brief description of one flag
+ * \param T c++ type of flag: bool, const char *, int, long, long long or
+ * double
+ */
+template <typename T>
+struct spec {
+  using value_type = T;
+
+  static constexpr ArgType type = type_of<T>::value;
+
+  std::string_view name;  // argument name (without first --)
+  char             shrt;  // short name, 0 if not provided
+  std::string_view desc;  // description
+  int              flags; // arg flags @see ArgFlags
+  T                dval;  // default value
+
+  constexpr spec(std::string_view name_,
+                 char             short_name,
+                 std::string_view desc_ = {}) noexcept
+      : name{name_}
+      , shrt{short_name}
+      , desc{desc_}
+      , flags{ArgNone}
+      , dval{} {
+  }
+
+  /**\return copy of the spec with ArgRequired flag
+   */
+  constexpr spec required() const noexcept {
+    spec retval = *this;
+    retval.flags |= ArgRequired;
+    return retval;
+  }
+
+  /**\return copy of the spec with given default value
+   */
+  constexpr spec def(T default_val) const noexcept {
+    spec retval = *this;
+    retval.flags |= ArgDefault;
+    retval.dval = default_val;
+    return retval;
+  }
+};
+
+
+/**\brief type erased spec, used by parse loop
+ */
+struct entry {
+  std::string_view name;
+  char             shrt;
+  std::string_view desc;
+  ArgType          type;
+  int              flags;
+  long long        ival; // default value for bool and integer types
+  double           dval; // default value for double
+  const char *     sval; // default value for string
+
+  template <typename T>
+  constexpr entry(const spec<T> &from) noexcept
+      : name{from.name}
+      , shrt{from.shrt}
+      , desc{from.desc}
+      , type{from.type}
+      , flags{from.flags}
+      , ival{}
+      , dval{}
+      , sval{} {
+    if constexpr (std::is_same_v<T, const char *>) {
+      sval = from.dval;
+    } else if constexpr (std::is_same_v<T, double>) {
+      dval = from.dval;
+    } else {
+      ival = from.dval;
+    }
+  }
+
+  /**\return default value of given type
+   */
+  template <typename T>
+  constexpr T def() const noexcept {
+    if constexpr (std::is_same_v<T, const char *>) {
+      return sval;
+    } else if constexpr (std::is_same_v<T, double>) {
+      return dval;
+    } else {
+      return static_cast<T>(ival);
+    }
+  }
+};
+
+
+/**\brief constexpr table of flags with perfect hash index of names
+ * \note the index is built by hash and displace: every name falls to a bucket
+ * by seed 0, then for every bucket a seed found, which moves all names of the
+ * bucket to free slots. Buckets with one name store the slot directly
+ */
+template <typename... Ts>
+struct schema {
+  static constexpr std::size_t size = sizeof...(Ts);
+
+  template <std::size_t I>
+  using value_type = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+  std::array<entry, size> entries;
+  std::array<int, size>   disp{};   // seed of bucket, or -slot - 1
+  std::array<int, size>   slots{};  // index of flag by slot
+  std::array<short, 256>  shorts{}; // index of flag + 1 by short name
+
+  constexpr schema(spec<Ts>... list)
+      : entries{{entry{list}...}} {
+    check_names();
+    build_index();
+  }
+
+  /**\return index of flag with given name (not normalized) or -1
+   */
+  constexpr int find(std::string_view name) const noexcept {
+    if constexpr (size == 0) {
+      return -1;
+    } else {
+      int d    = disp[name_hash(name, 0) % size];
+      int slot = d < 0 ? -d - 1 : name_hash(name, d) % size;
+      int idx  = slots[slot];
+      return name_eq(entries[idx].name, name) ? idx : -1;
+    }
+  }
+
+  /**\return index of flag with given short name or -1
+   */
+  constexpr int find_short(char c) const noexcept {
+    return shorts[static_cast<unsigned char>(c)] - 1;
+  }
+
+  /**\brief same as find, but for using in constant expressions
+   * \throw if the flag is not defined, which fails compilation
+   */
+  constexpr std::size_t index(std::string_view name) const {
+    int idx = find(name);
+    if (idx < 0) {
+      throw "flag is not defined in schema";
+    }
+    return idx;
+  }
+
+private:
+  constexpr void check_names() {
+    for (std::size_t i = 0; i < size; ++i) {
+      if (entries[i].name.empty()) {
+        throw "empty flag name";
+      }
+      for (std::size_t j = 0; j < i; ++j) {
+        if (name_eq(entries[i].name, entries[j].name)) {
+          throw "duplicated flag name";
+        }
+      }
+
+      if (entries[i].shrt) {
+        short &shrt = shorts[static_cast<unsigned char>(entries[i].shrt)];
+        if (shrt != 0) {
+          throw "duplicated short flag name";
+        }
+        shrt = i + 1;
+      }
+    }
+  }
+
+  constexpr void build_index() {
+    std::array<std::size_t, size> bucket{};
+    std::array<std::size_t, size> bucket_size{};
+    std::array<bool, size>        taken{};
+    std::size_t                   largest = 0;
+
+    for (std::size_t i = 0; i < size; ++i) {
+      bucket[i] = name_hash(entries[i].name, 0) % size;
+      if (++bucket_size[bucket[i]] > largest) {
+        largest = bucket_size[bucket[i]];
+      }
+    }
+
+    // buckets with several names from the largest one
+    for (std::size_t cur_size = largest; cur_size > 1; --cur_size) {
+      for (std::size_t b = 0; b < size; ++b) {
+        if (bucket_size[b] != cur_size) {
+          continue;
+        }
+
+        for (int seed = 1;; ++seed) {
+          if (seed == (1 << 20)) {
+            throw "can't build perfect hash";
+          }
+          if (try_place(bucket, b, seed, taken)) {
+            disp[b] = seed;
+            break;
+          }
+        }
+      }
+    }
+
+    // buckets with one name take any free slot
+    std::size_t free_slot = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+      if (bucket_size[bucket[i]] != 1) {
+        continue;
+      }
+      while (taken[free_slot]) {
+        ++free_slot;
+      }
+      taken[free_slot] = true;
+      slots[free_slot] = i;
+      disp[bucket[i]]  = -static_cast<int>(free_slot) - 1;
+    }
+  }
+
+  constexpr bool try_place(const std::array<std::size_t, size> &bucket,
+                           std::size_t                          b,
+                           int                                  seed,
+                           std::array<bool, size> &             taken) {
+    std::array<bool, size> local = taken;
+    for (std::size_t i = 0; i < size; ++i) {
+      if (bucket[i] != b) {
+        continue;
+      }
+      std::size_t slot = name_hash(entries[i].name, seed) % size;
+      if (local[slot]) {
+        return false;
+      }
+      local[slot] = true;
+    }
+
+    for (std::size_t i = 0; i < size; ++i) {
+      if (bucket[i] == b) {
+        slots[name_hash(entries[i].name, seed) % size] = i;
+      }
+    }
+    taken = local;
+    return true;
+  }
+};
+
+template <typename... Ts>
+constexpr schema<Ts...> make_schema(spec<Ts>... list) {
+  return schema<Ts...>(list...);
+}
+
+
+/**\brief parser for flags known at compile time
+ * \param Schema constexpr arg::schema object with static storage duration
+ * \note the parser doesn't allocate memory and doesn't copy strings, so string
+ * values point to argv. For repeated flags count and last value are stored
+ */
+template <const auto &Schema>
+class static_parser {
+  using schema_type = std::decay_t<decltype(Schema)>;
+
+  static constexpr std::size_t size = schema_type::size;
+
+public:
+  /**\brief parse args, same rules as for arg_parser_parse, including
+   * clusters of short flags and attached values (`-vj8`), @see
+   * arg_parser_match
+   * \return 0 if parsing was successfull, otherwise same error codes as
+   * arg_parser_parse returns
+   */
+  int parse(int argc, char *argv[], bool ignore_not_defined_flags = false) {
+    counts_ = {};
+    for (int val_iter = 1; val_iter < argc; ++val_iter) {
+      const char *flag = argv[val_iter];
+      if (flag[0] != '-') {
+        continue; // positional arg, ignore
+      }
+
+      const char *val   = nullptr;
+      unsigned    bools = 0;
+      int         idx   = match(flag, &val, &bools);
+      if (idx < 0) {
+        if (ignore_not_defined_flags) {
+          continue;
+        }
+        return fail(2, flag);
+      }
+      for (unsigned i = 1; i <= bools; ++i) {
+        store(Schema.find_short(flag[i]),
+              "true",
+              std::make_index_sequence<size>{});
+      }
+
+      if (val == nullptr) {
+        if (Schema.entries[idx].type != ArgBool) {
+          if (val_iter == argc - 1) {
+            return fail(1, flag);
+          }
+          val = argv[++val_iter];
+        } else if (val_iter == argc - 1 || argv[val_iter + 1][0] == '-') {
+          val = "true";
+        } else {
+          val = argv[++val_iter];
+        }
+      }
+
+      if (store(idx, val, std::make_index_sequence<size>{}) == false) {
+        return fail(4, flag);
+      }
+    }
+
+    for (std::size_t i = 0; i < size; ++i) {
+      if (counts_[i] == 0 && (Schema.entries[i].flags & ArgRequired)) {
+        return fail(3, Schema.entries[i].name);
+      }
+    }
+
+    return 0;
+  }
+
+  /**\return last value of flag with given index, default value or value
+   * initialized object if flag was not found
+   */
+  template <std::size_t I>
+  auto get() const noexcept {
+    using value_type = typename schema_type::template value_type<I>;
+    if (counts_[I] == 0) {
+      return Schema.entries[I].template def<value_type>();
+    }
+    return union_get<value_type>(vals_[I]);
+  }
+
+  /**\return last value of string flag with given index as view, length of
+   * value is found while parsing
+   */
+  template <std::size_t I>
+  std::string_view view() const noexcept {
+    using value_type = typename schema_type::template value_type<I>;
+    static_assert(std::is_same_v<value_type, const char *>,
+                  "view is available for string flags only");
+    if (counts_[I] == 0) {
+      const char *def = Schema.entries[I].template def<value_type>();
+      return def ? std::string_view(def) : std::string_view();
+    }
+    return std::string_view(vals_[I].val_str, lens_[I]);
+  }
+
+  /**\return count of values of flag with given index
+   */
+  template <std::size_t I>
+  unsigned count() const noexcept {
+    return counts_[I];
+  }
+
+  /**\return flag (or name of required flag) caused last parsing error
+   */
+  std::string_view error_flag() const noexcept {
+    return err_flag_;
+  }
+
+private:
+  /**\brief find flag in same forms as arg_parser_match does
+   * \param bools set to count of bool flags at begin of cluster of short flags
+   */
+  static int
+  match(const char *flag, const char **val, unsigned *bools) noexcept {
+    if (flag[1] == '\0') {
+      return -1;
+    }
+
+    if (flag[1] != '-') {
+      for (unsigned i = 1;; ++i) {
+        int idx = Schema.find_short(flag[i]);
+        if (idx < 0) {
+          return -1;
+        }
+
+        *bools = i - 1;
+        if (flag[i + 1] == '=') {
+          *val = flag + i + 2;
+          return idx;
+        }
+        if (flag[i + 1] == '\0') {
+          return idx;
+        }
+        if (Schema.entries[idx].type != ArgBool) {
+          *val = flag + i + 1; // attached value
+          return idx;
+        }
+      }
+    }
+
+    std::string_view name = flag + 2;
+    std::size_t      pos  = name.find('=');
+    if (pos != std::string_view::npos) {
+      *val = name.data() + pos + 1;
+      name = name.substr(0, pos);
+    }
+    return Schema.find(name);
+  }
+
+  template <std::size_t... I>
+  bool store(int idx, const char *val, std::index_sequence<I...>) noexcept {
+    bool retval = false;
+    ((static_cast<int>(I) == idx && (retval = store_one<I>(val), true)) ||
+     ...);
+    return retval;
+  }
+
+  template <std::size_t I>
+  bool store_one(const char *val) noexcept {
+    std::size_t len = std::strlen(val);
+    if (arg_val_from_range(Schema.entries[I].type,
+                           val,
+                           val + len,
+                           &vals_[I]) != 0) {
+      return false;
+    }
+    lens_[I] = len;
+    ++counts_[I];
+    return true;
+  }
+
+  int fail(int code, std::string_view flag) noexcept {
+    err_flag_ = flag;
+    return code;
+  }
+
+  std::array<ArgUnion, size>    vals_{};
+  std::array<unsigned, size>    counts_{};
+  std::array<std::size_t, size> lens_{};
+  std::string_view              err_flag_;
+};
+
+
+class parser;
+
+/**\brief flag bound to member of struct S
+ */
+template <typename S, typename T>
+struct field {
+  T S::*  member;
+  spec<T> arg;
+};
+
+template <typename S, typename T>
+constexpr field<S, T> make_field(T S::*member, const spec<T> &arg) noexcept {
+  return field<S, T>{member, arg};
+}
+
+
+/**\brief handle of flag added to arg::parser, reads values of last parsing
+ * directly from slot of the flag
+ * \param T c++ type of value, same as for arg::spec
+ * \note the handle is valid while parser, which returned it, exists. Moving
+ * of the parser keeps handles valid
+ */
+template <typename T>
+class flag {
+public:
+  flag() noexcept = default;
+
+  /**\return handle of the flag in arg_parser, -1 if adding failed
+   */
+  int handle() const noexcept {
+    return handle_;
+  }
+
+  /**\return count of values, values of list flags are counted separately
+   */
+  unsigned count() const noexcept {
+    return values().size();
+  }
+
+  /**\return all values without copying, valid until next parsing
+   */
+  span<T> values() const noexcept {
+    if (parser_ == nullptr) {
+      return {};
+    }
+    unsigned    len  = 0;
+    const void *vals = arg_parser_hget_list(parser_, handle_, type_, &len);
+    return span<T>(static_cast<const T *>(vals), len);
+  }
+
+  /**\return last value (or default value), std::nullopt if flag has no values
+   */
+  std::optional<T> get() const noexcept {
+    span<T> vals = values();
+    if (vals.empty()) {
+      return std::nullopt;
+    }
+    return vals.back();
+  }
+
+  T value_or(T def) const noexcept {
+    return get().value_or(def);
+  }
+
+  /**\return string value with given index as view, @see hget_view
+   */
+  std::string_view view(unsigned index = 0) const noexcept {
+    static_assert(std::is_same_v<T, const char *>,
+                  "view is available for string flags only");
+    return parser_ ? hget_view(parser_, handle_, index) : std::string_view();
+  }
+
+private:
+  friend class parser;
+
+  flag(const arg_parser *parser, int handle, ArgType type) noexcept
+      : parser_{parser}
+      , handle_{handle}
+      , type_{type} {
+  }
+
+  const arg_parser *parser_ = nullptr;
+  int               handle_ = -1;
+  ArgType           type_   = ArgBool;
+};
+
+
+/**\brief owner of arg_parser
+ * \note the parser is movable, but not copyable. String values point to argv
+ * as for arg_parser
+ */
+class parser {
+public:
+  explicit parser(const char *desc = nullptr)
+      : parser_{arg_parser_make(desc)} {
+  }
+
+  parser(parser &&other) noexcept
+      : parser_{std::exchange(other.parser_, nullptr)}
+      , err_{std::exchange(other.err_, nullptr)} {
+  }
+
+  parser &operator=(parser &&other) noexcept {
+    if (this != &other) {
+      release();
+      parser_ = std::exchange(other.parser_, nullptr);
+      err_    = std::exchange(other.err_, nullptr);
+    }
+    return *this;
+  }
+
+  parser(const parser &)            = delete;
+  parser &operator=(const parser &) = delete;
+
+  ~parser() {
+    release();
+  }
+
+  /**\brief add flag described by spec
+   * \return handle of the flag
+   */
+  template <typename T>
+  flag<T> add(const spec<T> &arg) {
+    return add_as<T>(arg, type_of<T>::value, union_make<T>(arg.dval));
+  }
+
+  /**\brief add list flag, values of the flag are separated by ARG_LIST_SEP
+   * \param def default value as string, which is parsed as the values
+   */
+  template <typename T>
+  flag<T> add_list(const spec<T> &arg, const char *def = nullptr) {
+    spec<T> list = arg;
+    list.flags   = def ? list.flags | ArgDefault : list.flags & ~ArgDefault;
+    return add_as<T>(list, list_of<T>::value, union_make(def));
+  }
+
+  /**\brief add flag, last value of which is written to dst after every
+   * successfull parsing, @see arg_parser_bind
+   * \return invalid flag (handle -1) if dst is nullptr or flag can't be
+   * added or bound
+   */
+  template <typename T>
+  flag<T> bind(T *dst, const spec<T> &arg) {
+    if (dst == nullptr) {
+      return {};
+    }
+    flag<T> retval = add(arg);
+    if (arg_parser_bind(parser_, retval.handle(), dst) != 0) {
+      return {};
+    }
+    return retval;
+  }
+
+  /**\brief add flags of table of fields bound to members of obj
+   * \param table tuple of arg::field
+   */
+  template <typename S, typename... Ts>
+  void bind(S &obj, const std::tuple<field<S, Ts>...> &table) {
+    std::apply(
+        [this, &obj](const field<S, Ts> &...list) {
+          (bind(&(obj.*list.member), list.arg), ...);
+        },
+        table);
+  }
+
+  /**\brief parse args, @see arg_parser_parse
+   * \return 0 if parsing was successfull, otherwise error code
+   */
+  int parse(int *   argc,
+            char ***argv,
+            bool    ignore_not_defined_flags,
+            bool    remove_defined_flags_from_argv) {
+    free(std::exchange(err_, nullptr));
+    return arg_parser_parse(parser_,
+                            argc,
+                            argv,
+                            ignore_not_defined_flags,
+                            remove_defined_flags_from_argv,
+                            &err_);
+  }
+
+  int parse(int argc, char *argv[], bool ignore_not_defined_flags = false) {
+    return parse(&argc, &argv, ignore_not_defined_flags, false);
+  }
+
+  /**\return message of last parsing error, empty if parsing was successfull
+   */
+  std::string_view error() const noexcept {
+    return err_ ? std::string_view(err_) : std::string_view();
+  }
+
+  std::string_view usage() {
+    return arg_parser_usage_cached(parser_);
+  }
+
+  /**\return underlying arg_parser for using of C api
+   */
+  arg_parser *get() const noexcept {
+    return parser_;
+  }
+
+private:
+  template <typename T>
+  flag<T> add_as(const spec<T> &arg, ArgType type, ArgUnion def) {
+    // names of spec are views, so copy them for null terminated ones
+    std::string name(arg.name);
+    std::string desc(arg.desc);
+    int         handle = arg_parser_add_arg(parser_,
+                                    name.c_str(),
+                                    arg.shrt,
+                                    desc.c_str(),
+                                    type,
+                                    arg.flags,
+                                    def);
+    return flag<T>(parser_, handle, type);
+  }
+
+  void release() noexcept {
+    free(std::exchange(err_, nullptr));
+    if (parser_) {
+      arg_parser_dispose(std::exchange(parser_, nullptr));
+    }
+  }
+
+  arg_parser *parser_ = nullptr;
+  char *      err_    = nullptr;
+};
+
+} // namespace arg
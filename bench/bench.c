@@ -0,0 +1,513 @@
+/**\file
+ * Benchmarks for arg_parser.
+ *
+ * Every case runs in a forked process, so peak RSS reported for a case
+ * belongs only to it. Argv is generated by fixed seed, so runs are
+ * reproducible.
+ *
+ * Usage: bench [max_tokens]
+ */
+
+#include "arg_parser.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// getopt_long cases with bigger count of operations are skipped
+#define BENCH_MAX_OPS 2000000000ull
+
+// count of command lines parsed by arg_parser_parse_many, independent of
+// max_tokens, so results are comparable across runs
+#define BENCH_MANY_JOBS 1000000u
+
+
+enum BenchMode {
+  BenchEqForm,       // --flag=val
+  BenchSeparateForm, // --flag val
+  BenchRemove,       // --flag=val with positionals, remove defined flags
+  BenchRepeated,     // --flag=val, all tokens for one flag
+  BenchGetopt,       // --flag=val by getopt_long
+};
+
+static const char *bench_mode_name[] = {
+    "eq-form",
+    "separate-form",
+    "remove-flags",
+    "repeated-flag",
+    "getopt-long",
+};
+
+
+typedef struct _bench_argv {
+  int    argc;
+  char **argv;
+  char * data;
+} bench_argv;
+
+
+static unsigned bench_seed = 0;
+
+static unsigned bench_rand() {
+  bench_seed ^= bench_seed << 13;
+  bench_seed ^= bench_seed >> 17;
+  bench_seed ^= bench_seed << 5;
+  return bench_seed;
+}
+
+static double bench_now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+static arg_parser *bench_make_parser(unsigned flags) {
+  arg_parser *parser = arg_parser_make("bench");
+  char        name[32];
+  for (unsigned i = 0; i < flags; ++i) {
+    snprintf(name, sizeof(name), "flag_%u", i);
+    ARG_PARSER_ADD_INT(parser, name, 0, "benchmark flag", false);
+  }
+  return parser;
+}
+
+/**\brief generate argv with `tokens` elements after program name
+ */
+static bench_argv
+bench_make_argv(enum BenchMode mode, unsigned flags, unsigned tokens) {
+  bench_argv retval;
+  size_t     offset = 0;
+
+  retval.argc    = tokens + 1;
+  retval.argv    = (char **)malloc(sizeof(char *) * (tokens + 2));
+  retval.data    = (char *)malloc(32 * (size_t)(tokens + 1));
+  retval.argv[0] = (char *)"bench";
+
+  bench_seed = 2463534242u;
+  for (unsigned i = 1; i <= tokens; ++i) {
+    unsigned flag = mode == BenchRepeated ? 0 : bench_rand() % flags;
+    char *   str  = retval.data + offset;
+    int      len  = 0;
+
+    if (mode == BenchSeparateForm && i < tokens) {
+      len              = snprintf(str, 32, "--flag-%u", flag);
+      retval.argv[i++] = str;
+      offset += len + 1;
+      str = retval.data + offset;
+      len = snprintf(str, 32, "%u", bench_rand() % 100000);
+    } else if (mode == BenchRemove && bench_rand() % 4 == 0) {
+      len = snprintf(str, 32, "positional-%u", i);
+    } else {
+      len = snprintf(str, 32, "--flag-%u=%u", flag, bench_rand() % 100000);
+    }
+
+    retval.argv[i] = str;
+    offset += len + 1;
+  }
+  retval.argv[tokens + 1] = NULL;
+
+  return retval;
+}
+
+static double bench_getopt(bench_argv *args, unsigned flags, int reps) {
+  struct option *opts = (struct option *)calloc(flags + 1, sizeof(*opts));
+  char *         names = (char *)malloc(32 * (size_t)flags);
+  for (unsigned i = 0; i < flags; ++i) {
+    snprintf(names + 32 * i, 32, "flag-%u", i);
+    opts[i].name    = names + 32 * i;
+    opts[i].has_arg = required_argument;
+    opts[i].flag    = NULL;
+    opts[i].val     = 0;
+  }
+
+  double best = 0;
+  for (int rep = 0; rep < reps; ++rep) {
+    double start = bench_now_ns();
+    int    sum   = 0;
+    optind       = 0;
+    while (getopt_long(args->argc, args->argv, "", opts, NULL) != -1) {
+      sum += atoi(optarg);
+    }
+    double time = bench_now_ns() - start;
+    if (rep == 0 || time < best) {
+      best = time;
+    }
+    if (sum == -1) {
+      printf("unreachable\n");
+    }
+  }
+
+  free(names);
+  free(opts);
+  return best;
+}
+
+static double bench_parse(bench_argv *    args,
+                          enum BenchMode  mode,
+                          unsigned        flags,
+                          int             reps,
+                          unsigned *      allocs) {
+  char **argv = (char **)malloc(sizeof(char *) * (args->argc + 1));
+  double best = 0;
+  for (int rep = 0; rep < reps; ++rep) {
+    arg_parser *parser = bench_make_parser(flags);
+    int         argc   = args->argc;
+    char *      err    = NULL;
+    memcpy(argv, args->argv, sizeof(char *) * (args->argc + 1));
+
+    double start  = bench_now_ns();
+    int    result = ARG_PARSER_PARSE(parser,
+                                  argc,
+                                  argv,
+                                  false,
+                                  mode == BenchRemove,
+                                  &err);
+    double time   = bench_now_ns() - start;
+    if (result != 0) {
+      printf("parsing failed: %s\n", err);
+      free(err);
+      exit(EXIT_FAILURE);
+    }
+
+    if (rep == 0 || time < best) {
+      best = time;
+    }
+    *allocs = arg_parser_alloc_count(parser);
+    arg_parser_dispose(parser);
+  }
+
+  free(argv);
+  return best;
+}
+
+/**\brief run parsing case in child process
+ */
+static void bench_parse_case(enum BenchMode mode,
+                             unsigned       flags,
+                             unsigned       tokens) {
+  unsigned long long ops = 0;
+  if (mode == BenchGetopt) {
+    ops = (unsigned long long)tokens * flags;
+  }
+  if (ops > BENCH_MAX_OPS) {
+    printf("%-14s %8u %9u %12s\n",
+           bench_mode_name[mode],
+           flags,
+           tokens,
+           "skip");
+    return;
+  }
+
+  fflush(stdout);
+  int   fds[2];
+  pid_t pid;
+  if (pipe(fds) != 0 || (pid = fork()) < 0) {
+    perror("bench");
+    exit(EXIT_FAILURE);
+  }
+
+  if (pid == 0) {
+    bench_argv args   = bench_make_argv(mode, flags, tokens);
+    int        reps   = tokens >= 100000 ? 3 : 1000000 / tokens;
+    if (mode != BenchGetopt && reps > (int)(100000 / flags) + 1) {
+      reps = 100000 / flags + 1; // every repetition builds new parser
+    }
+    unsigned   allocs = 0;
+    double     time   = mode == BenchGetopt
+                            ? bench_getopt(&args, flags, reps)
+                            : bench_parse(&args, mode, flags, reps, &allocs);
+    double     ns     = time / tokens;
+
+    if (write(fds[1], &ns, sizeof(ns)) != sizeof(ns) ||
+        write(fds[1], &allocs, sizeof(allocs)) != sizeof(allocs)) {
+      _exit(EXIT_FAILURE);
+    }
+    _exit(EXIT_SUCCESS);
+  }
+
+  double        ns     = 0;
+  unsigned      allocs = 0;
+  int           status = 0;
+  struct rusage usage;
+  close(fds[1]);
+  if (read(fds[0], &ns, sizeof(ns)) != sizeof(ns) ||
+      read(fds[0], &allocs, sizeof(allocs)) != sizeof(allocs)) {
+    printf("case failed\n");
+    exit(EXIT_FAILURE);
+  }
+  close(fds[0]);
+  wait4(pid, &status, 0, &usage);
+
+  printf("%-14s %8u %9u %12.2f %8u %10ld\n",
+         bench_mode_name[mode],
+         flags,
+         tokens,
+         ns,
+         allocs,
+         usage.ru_maxrss);
+}
+
+/**\brief time lookups by name and usage for schema with given size
+ */
+static void bench_lookup_case(unsigned flags) {
+  arg_parser *parser = bench_make_parser(flags);
+  bench_argv  args   = bench_make_argv(BenchEqForm, flags, flags);
+  char **     names  = (char **)malloc(sizeof(char *) * flags);
+  for (unsigned i = 0; i < flags; ++i) {
+    names[i] = (char *)malloc(32);
+    snprintf(names[i], 32, "flag-%u", i);
+  }
+
+  if (ARG_PARSER_PARSE(parser, args.argc, args.argv, false, false, NULL)) {
+    printf("parsing failed\n");
+    exit(EXIT_FAILURE);
+  }
+
+  int    sum   = 0;
+  double start = bench_now_ns();
+  for (unsigned i = 0; i < flags; ++i) {
+    int val = 0;
+    sum += ARG_PARSER_GET_INT(parser, names[i], val);
+  }
+  double get_ns = (bench_now_ns() - start) / flags;
+
+  start = bench_now_ns();
+  for (unsigned i = 0; i < flags; ++i) {
+    sum += arg_parser_count(parser, names[i]);
+  }
+  double count_ns = (bench_now_ns() - start) / flags;
+
+  start       = bench_now_ns();
+  char *usage = arg_parser_usage(parser);
+  double usage_ns = (bench_now_ns() - start) / flags;
+  free(usage);
+
+  printf("%8u %12.2f %12.2f %12.2f\n", flags, get_ns, count_ns, usage_ns);
+  if (sum < 0) {
+    printf("unreachable\n");
+  }
+
+  for (unsigned i = 0; i < flags; ++i) {
+    free(names[i]);
+  }
+  free(names);
+  free(args.argv);
+  free(args.data);
+  arg_parser_dispose(parser);
+}
+
+/**\brief time conversion of numeric values by libc and by arg_val_from_str
+ */
+static void bench_convert_case(enum ArgType type, const char *name) {
+  const unsigned count = 1000000;
+  char *         data  = (char *)malloc(32 * (size_t)count);
+  bench_seed           = 2463534242u;
+  for (unsigned i = 0; i < count; ++i) {
+    unsigned long long big = (unsigned long long)bench_rand() << 32;
+    char *             str = data + 32 * (size_t)i;
+    if (type == ArgInt) {
+      snprintf(str, 32, "%d", (int)bench_rand() / 2);
+    } else if (type == ArgLongLong) {
+      snprintf(str, 32, "%llu", (big | bench_rand()) >> 1);
+    } else {
+      snprintf(str, 32, "%u.%03u", bench_rand() % 100000, bench_rand() % 1000);
+    }
+  }
+
+  double libc_ns = 0;
+  double arg_ns  = 0;
+  double sum     = 0;
+  for (int rep = 0; rep < 5; ++rep) {
+    double start = bench_now_ns();
+    for (unsigned i = 0; i < count; ++i) {
+      const char *str    = data + 32 * (size_t)i;
+      char *      endval = NULL;
+      if (type == ArgDouble) {
+        sum += strtod(str, &endval);
+      } else {
+        sum += strtoll(str, &endval, 0);
+      }
+      sum += endval != str + strlen(str);
+    }
+    double time = (bench_now_ns() - start) / count;
+    if (rep == 0 || time < libc_ns) {
+      libc_ns = time;
+    }
+
+    start = bench_now_ns();
+    for (unsigned i = 0; i < count; ++i) {
+      union ArgUnion val;
+      sum += arg_val_from_str(type, data + 32 * (size_t)i, &val);
+      sum += type == ArgDouble ? val.val_double : val.val_ll;
+    }
+    time = (bench_now_ns() - start) / count;
+    if (rep == 0 || time < arg_ns) {
+      arg_ns = time;
+    }
+  }
+
+  printf("%-8s %12.2f %12.2f %8.2fx\n",
+         name,
+         libc_ns,
+         arg_ns,
+         libc_ns / arg_ns);
+  if (sum == -1) {
+    printf("unreachable\n");
+  }
+  free(data);
+}
+
+/**\brief time parsing of many short command lines by arg_parser_parse_many
+ */
+static void bench_many_case(unsigned jobs, int nthreads) {
+  const unsigned flags  = 10;
+  const unsigned tokens = 8;
+  arg_parser *   parser = bench_make_parser(flags);
+  bench_argv     args   = bench_make_argv(BenchEqForm, flags, tokens);
+  int *          argcs  = (int *)malloc(sizeof(int) * jobs);
+  char ***       argvs  = (char ***)malloc(sizeof(char **) * jobs);
+  arg_result *   res    = (arg_result *)malloc(sizeof(arg_result) * jobs);
+  for (unsigned i = 0; i < jobs; ++i) {
+    argcs[i] = args.argc;
+    argvs[i] = args.argv;
+    arg_result_init(&res[i]);
+  }
+
+  double start  = bench_now_ns();
+  int    failed = arg_parser_parse_many(parser,
+                                     jobs,
+                                     argcs,
+                                     argvs,
+                                     res,
+                                     nthreads);
+  double ms     = (bench_now_ns() - start) / 1e6;
+  if (failed != 0) {
+    printf("parsing failed\n");
+    exit(EXIT_FAILURE);
+  }
+
+  printf("%8u %8d %12.2f %12.2f\n", jobs, nthreads, ms, ms * 1e6 / jobs);
+
+  for (unsigned i = 0; i < jobs; ++i) {
+    arg_result_release(&res[i]);
+  }
+  free(res);
+  free(argvs);
+  free(argcs);
+  free(args.argv);
+  free(args.data);
+  arg_parser_dispose(parser);
+}
+
+/**\brief time parsing of count ids passed by repeated flag and by one list
+ */
+static void bench_list_case(unsigned count) {
+  arg_parser *parser = arg_parser_make(NULL);
+  int         id     = ARG_PARSER_ADD_INT(parser, "id", 0, NULL, false);
+  int         ids    = ARG_PARSER_ADD_INT_LIST(parser, "ids", 0, NULL, false);
+  char *      data   = (char *)malloc(16 * (size_t)count + 16);
+  char **     argv   = (char **)malloc(sizeof(char *) * (count + 1));
+  char *      list   = (char *)malloc(11 * (size_t)count + 16);
+  char *      iter   = list + sprintf(list, "--ids=");
+  int         argc   = count + 1;
+
+  argv[0] = (char *)"bench";
+  for (unsigned i = 0; i < count; ++i) {
+    argv[i + 1] = data + 16 * (size_t)i;
+    snprintf(argv[i + 1], 16, "--id=%u", i);
+    iter += sprintf(iter, i ? ",%u" : "%u", i);
+  }
+
+  double repeat_ns = 0;
+  double list_ns   = 0;
+  for (int rep = 0; rep < 5; ++rep) {
+    int    repeat_argc = argc;
+    char **repeat_argv = argv;
+    double start       = bench_now_ns();
+    arg_parser_parse(parser, &repeat_argc, &repeat_argv, false, false, NULL);
+    double time = (bench_now_ns() - start) / count;
+    if (rep == 0 || time < repeat_ns) {
+      repeat_ns = time;
+    }
+
+    char * list_args[] = {(char *)"bench", list};
+    int    list_argc   = 2;
+    char **list_argv   = list_args;
+    start              = bench_now_ns();
+    arg_parser_parse(parser, &list_argc, &list_argv, false, false, NULL);
+    time = (bench_now_ns() - start) / count;
+    if (rep == 0 || time < list_ns) {
+      list_ns = time;
+    }
+  }
+
+  unsigned len = 0;
+  if (ARG_PARSER_HGET_INT_LIST(parser, ids, len) == NULL || len != count ||
+      arg_parser_hcount(parser, id) != 0) {
+    printf("parsing failed\n");
+    exit(EXIT_FAILURE);
+  }
+  printf("%8u %14.2f %12.2f\n", count, repeat_ns, list_ns);
+
+  free(list);
+  free(argv);
+  free(data);
+  arg_parser_dispose(parser);
+}
+
+
+int main(int argc, char *argv[]) {
+  unsigned schema_sizes[] = {10, 100, 1000, 10000};
+  unsigned argv_sizes[]   = {10, 1000, 100000, 1000000};
+  unsigned max_tokens     = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+
+  printf("%-14s %8s %9s %12s %8s %10s\n",
+         "case",
+         "flags",
+         "tokens",
+         "ns/token",
+         "allocs",
+         "rss(KB)");
+  for (unsigned i = 0; i < sizeof(schema_sizes) / sizeof(unsigned); ++i) {
+    for (unsigned j = 0; j < sizeof(argv_sizes) / sizeof(unsigned); ++j) {
+      if (argv_sizes[j] > max_tokens) {
+        continue;
+      }
+      for (int mode = BenchEqForm; mode <= BenchGetopt; ++mode) {
+        bench_parse_case((enum BenchMode)mode, schema_sizes[i], argv_sizes[j]);
+      }
+    }
+  }
+
+  printf("\n%8s %12s %12s %12s\n",
+         "flags",
+         "get ns/flag",
+         "count ns",
+         "usage ns");
+  for (unsigned i = 0; i < sizeof(schema_sizes) / sizeof(unsigned); ++i) {
+    bench_lookup_case(schema_sizes[i]);
+  }
+
+  printf("\n%-8s %12s %12s %9s\n", "type", "libc ns", "arg ns", "speedup");
+  bench_convert_case(ArgInt, "int");
+  bench_convert_case(ArgLongLong, "ll");
+  bench_convert_case(ArgDouble, "double");
+
+  printf("\n%8s %14s %12s\n", "values", "repeat ns/val", "list ns/val");
+  for (unsigned count = 10; count <= max_tokens && count <= 100000;
+       count *= 100) {
+    bench_list_case(count);
+  }
+
+  printf("\n%8s %8s %12s %12s\n", "jobs", "threads", "ms", "ns/job");
+  int nthreads[] = {1, 0};
+  for (unsigned i = 0; i < sizeof(nthreads) / sizeof(int); ++i) {
+    bench_many_case(BENCH_MANY_JOBS, nthreads[i]);
+  }
+
+  return EXIT_SUCCESS;
+}
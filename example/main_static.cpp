@@ -0,0 +1,39 @@
+#include "arg_parser.hpp"
+#include <iostream>
+
+static constexpr auto cli = arg::make_schema(
+    arg::spec<bool>("help", 'h', "print usage info"),
+    arg::spec<int>("some_int", 'i', "int value").required(),
+    arg::spec<long>("some_long", 0, "long value"),
+    arg::spec<long long>("some_ll", 0, "ll value"),
+    arg::spec<double>("some_double", 0, "double value"),
+    arg::spec<const char *>("some_str", 0, "string value"),
+    arg::spec<bool>("some_bool_d", 0, "bool value wiht default").def(true),
+    arg::spec<int>("some_int_d", 0, "int value with default").def(8000),
+    arg::spec<long>("some_long_d", 0, "long value with default").def(8),
+    arg::spec<long long>("some_ll_d", 0, "ll value with default").def(10),
+    arg::spec<double>("some_double_d", 0, "double value with default")
+        .def(0.1),
+    arg::spec<const char *>("some_str_d", 0, "string value with default")
+        .def("default"));
+
+int main(int argc, char *argv[]) {
+  arg::static_parser<cli> parser;
+  int                     result = parser.parse(argc, argv);
+
+  if (parser.get<cli.index("help")>()) {
+    for (const arg::entry &entry : cli.entries) {
+      std::cout << "  --" << entry.name << " " << entry.desc << std::endl;
+    }
+    return EXIT_FAILURE;
+  }
+
+  if (result != 0) {
+    std::cout << "fail parsing args: " << parser.error_flag() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+
+  std::cout << parser.get<cli.index("some_double_d")>() << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -1,6 +1,7 @@
 #include "arg_parser.h"
 #include <assert.h>
 #include <string.h>
+#include <unistd.h>
 
 
 void check_arg_parser_create_and_dispose_only_with_desc(const char *desc) {
@@ -304,6 +305,1536 @@ void check_positional_args() {
   arg_parser_dispose(parser);
 }
 
+void check_many_flags() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  char names[300][32];
+  for (int i = 0; i < 300; ++i) {
+    snprintf(names[i], sizeof(names[i]), "Flag_%i", i);
+    ARG_PARSER_ADD_INT(parser, names[i], 0, NULL, false);
+  }
+  ARG_PARSER_ADD_BOOL(parser, "verbose", 'v', NULL, false);
+
+  // clang-format off
+  int argc = 5;
+  char *args[] = {"program",
+                  "--flag-150=15",
+                  "--FLAG_299", "299",
+                  "-v"};
+  // clang-format on
+  char **argv   = args;
+  int    result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+
+  int  int_value  = 0;
+  bool bool_value = false;
+  assert(ARG_PARSER_GET_INT(parser, "flag-150", int_value) == 1);
+  assert(int_value == 15);
+  assert(ARG_PARSER_GET_INT(parser, "flag_299", int_value) == 1);
+  assert(int_value == 299);
+  assert(ARG_PARSER_GET_INT(parser, "flag-0", int_value) == 0);
+  assert(ARG_PARSER_GET_BOOL(parser, "verbose", bool_value) == 1);
+  assert(bool_value == true);
+
+  // all parser memory comes from a few geometrically growing blocks
+  assert(arg_parser_alloc_count(parser) < 10);
+
+  char *unknown_args[] = {"program", "--flag-300=1"};
+  argc                 = 2;
+  argv                 = unknown_args;
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result != 0);
+
+  arg_parser_dispose(parser);
+}
+
+void check_handles() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  int level = ARG_PARSER_ADD_INT(parser, "level", 'l', NULL, false);
+  int name  = ARG_PARSER_ADD_STRD(parser, "name", 0, NULL, "default");
+  int other = ARG_PARSER_ADD_DOUBLE(parser, "other", 0, NULL, false);
+
+  assert(arg_parser_handle(parser, "LEVEL") == level);
+  assert(arg_parser_handle(parser, "name") == name);
+  assert(arg_parser_handle(parser, "unknown") == -1);
+
+  // clang-format off
+  int argc = 5;
+  char *args[] = {"program",
+                  "--level=1",
+                  "-l", "2",
+                  "-l=3"};
+  // clang-format on
+  char **argv   = args;
+  int    result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+
+  int         int_value = 0;
+  const char *str       = NULL;
+  double      dbl_value = 0;
+  assert(arg_parser_hcount(parser, level) == 3);
+  assert(ARG_PARSER_HGET_INT(parser, level, int_value) == 1);
+  assert(int_value == 1);
+  assert(ARG_PARSER_HGET_LAST_ARG(parser, level, int_value, int) == 1);
+  assert(int_value == 3);
+  assert(ARG_PARSER_HGET_STR(parser, name, str) == 1);
+  assert(strcmp(str, "default") == 0);
+  assert(ARG_PARSER_HGET_DOUBLE(parser, other, dbl_value) == 0);
+  assert(ARG_PARSER_HGET_DOUBLE(parser, level, dbl_value) < 0);
+
+  arg_parser_dispose(parser);
+}
+
+// clang-format off
+ARG_PARSER_DEFINE_STATIC(static_args,
+    ARG_STATIC_STR("string", 's', "required string", true),
+    ARG_STATIC_INT("int", 'i', "not required int", false),
+    ARG_STATIC_LLD("long-long-def", 0, "long long with default value", 8),
+    ARG_STATIC_DOUBLED("double-def", 'd', "double with default value", 7.6),
+    ARG_STATIC_BOOL("bool", 'b', "not required bool", false),
+);
+// clang-format on
+
+void check_static_args() {
+  arg_parser *parser = ARG_PARSER_MAKE_STATIC("main desc:", static_args);
+  assert(parser->alist == static_args);
+
+  const char *target_usage =
+      "main desc:\n"
+      "  -s, --string                 required string\n"
+      "  -i, --int                    not required int\n"
+      "      --long-long-def (=8)     long long with default value\n"
+      "  -d, --double-def (=7.600000) double with default value\n"
+      "  -b, --bool                   not required bool\n";
+
+  char *usage  = arg_parser_usage(parser);
+  int   result = strcmp(usage, target_usage);
+  assert(result == 0);
+  free(usage);
+
+  // clang-format off
+  int argc = 5;
+  char *args[] = {"program",
+                  "--STRING", "string",
+                  "-b",
+                  "--int=3"};
+  // clang-format on
+  char **argv = args;
+  result      = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+
+  const char *str          = NULL;
+  int         int_value    = 0;
+  long long   ll_value     = 0;
+  double      double_value = 0;
+  bool        bool_value   = false;
+
+  ARG_PARSER_GET_STR(parser, "string", str);
+  ARG_PARSER_GET_INT(parser, "int", int_value);
+  ARG_PARSER_GET_LL(parser, "long_long_def", ll_value);
+  ARG_PARSER_GET_DOUBLE(parser, "double-def", double_value);
+  ARG_PARSER_GET_BOOL(parser, "bool", bool_value);
+
+  assert(strcmp(str, "string") == 0);
+  assert(int_value == 3);
+  assert(ll_value == 8);
+  assert(double_value > 7.5 && double_value < 7.7);
+  assert(bool_value == true);
+
+  // adding of arg copies the list to parser
+  ARG_PARSER_ADD_INT(parser, "other", 'o', NULL, false);
+  assert(parser->alist != static_args);
+  assert(arg_parser_handle(parser, "string") == 0);
+  assert(arg_parser_handle(parser, "other") == 5);
+
+  arg_parser_dispose(parser);
+}
+
+void write_file(char *path, const char *content, size_t size) {
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  assert(write(fd, content, size) == (ssize_t)size);
+  close(fd);
+}
+
+void check_response_files() {
+  arg_parser *parser = arg_parser_make(NULL);
+  arg_parser_set_opts(parser, ArgParserResponseFiles);
+
+  ARG_PARSER_ADD_STR(parser, "name", 'n', NULL, false);
+  ARG_PARSER_ADD_INT(parser, "num", 0, NULL, false);
+
+  char nested[] = "/tmp/arg_parser_nested_XXXXXX";
+  char top[]    = "/tmp/arg_parser_top_XXXXXX";
+  char page[]   = "/tmp/arg_parser_page_XXXXXX";
+
+  const char *nested_content = "--num 7\n--name=a\\\"b";
+  write_file(nested, nested_content, strlen(nested_content));
+
+  char top_content[256];
+  snprintf(top_content,
+           sizeof(top_content),
+           "--name \"quoted value\" -n 'single \\ quote'\n"
+           "pos\\ 1 @%s\n"
+           "--num=3\n",
+           nested);
+  write_file(top, top_content, strlen(top_content));
+
+  // content without space at the end, which fills whole page
+  char page_content[4096];
+  memset(page_content, ' ', sizeof(page_content));
+  memcpy(page_content + sizeof(page_content) - 7, "--num=1", 7);
+  write_file(page, page_content, sizeof(page_content));
+
+  char top_arg[64];
+  char page_arg[64];
+  snprintf(top_arg, sizeof(top_arg), "@%s", top);
+  snprintf(page_arg, sizeof(page_arg), "@%s", page);
+
+  int    argc   = 4;
+  char * args[] = {"program", top_arg, "last", page_arg};
+  char **argv   = args;
+  int    result = ARG_PARSER_PARSE(parser, argc, argv, false, true, NULL);
+  assert(result == 0);
+
+  assert(argc == 3);
+  assert(strcmp(argv[0], "program") == 0);
+  assert(strcmp(argv[1], "pos 1") == 0);
+  assert(strcmp(argv[2], "last") == 0);
+
+  const char *names[3];
+  int         nums[3];
+  assert(arg_parser_get_args(parser, "name", ArgString, names, 3) == 3);
+  assert(arg_parser_get_args(parser, "num", ArgInt, nums, 3) == 3);
+  assert(strcmp(names[0], "quoted value") == 0);
+  assert(strcmp(names[1], "single \\ quote") == 0);
+  assert(strcmp(names[2], "a\"b") == 0);
+  assert(nums[0] == 7 && nums[1] == 3 && nums[2] == 1);
+
+  char * missing_args[] = {"program", "@/nonexistent/arg_parser_file"};
+  char * err            = NULL;
+  argc                  = 2;
+  argv                  = missing_args;
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, false, &err);
+  assert(result == 5);
+  assert(strcmp(err, "can't read file: /nonexistent/arg_parser_file") == 0);
+  free(err);
+
+  // file which includes itself by other file fails at first repeat
+  char self[]  = "/tmp/arg_parser_self_XXXXXX";
+  char other[] = "/tmp/arg_parser_other_XXXXXX";
+  write_file(self, "", 0);
+  write_file(other, "", 0);
+  char self_content[128];
+  snprintf(self_content,
+           sizeof(self_content),
+           "@%s @%s @%s @%s",
+           other,
+           other,
+           other,
+           other);
+  FILE *file = fopen(self, "w");
+  fputs(self_content, file);
+  fclose(file);
+  file = fopen(other, "w");
+  fprintf(file, "--num=1 @%s", self);
+  fclose(file);
+
+  char  self_arg[64];
+  char *self_args[] = {"program", self_arg};
+  snprintf(self_arg, sizeof(self_arg), "@%s", self);
+  argc   = 2;
+  argv   = self_args;
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, false, &err);
+  assert(result == 5);
+  assert(strncmp(err, "recursive response file: ", 25) == 0);
+  assert(strcmp(err + 25, self) == 0);
+  free(err);
+
+  unlink(self);
+  unlink(other);
+  unlink(nested);
+  unlink(top);
+  unlink(page);
+  arg_parser_dispose(parser);
+}
+
+void check_feed() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  ARG_PARSER_ADD_STR(parser, "name", 'n', NULL, false);
+  ARG_PARSER_ADD_INT(parser, "num", 0, NULL, true);
+  ARG_PARSER_ADD_INTD(parser, "def", 0, NULL, 5);
+  ARG_PARSER_ADD_BOOL(parser, "verbose", 'v', NULL, false);
+
+  // value of flag passed by next call, string is copied
+  char buf[16] = "-n";
+  assert(arg_parser_feed(parser, buf, false, NULL) == 0);
+  strcpy(buf, "value");
+  assert(arg_parser_feed(parser, buf, false, NULL) == 0);
+  strcpy(buf, "garbage");
+
+  assert(arg_parser_feed(parser, "positional", false, NULL) == 0);
+  assert(arg_parser_feed(parser, "-v", false, NULL) == 0);
+  assert(arg_parser_feed(parser, "--num=3", false, NULL) == 0);
+  assert(arg_parser_feed(parser, "--unknown", true, NULL) == 0);
+  assert(arg_parser_finish(parser, NULL) == 0);
+
+  const char *name    = NULL;
+  int         num     = 0;
+  int         def     = 0;
+  bool        verbose = false;
+  assert(ARG_PARSER_GET_STR(parser, "name", name) == 1);
+  assert(ARG_PARSER_GET_INT(parser, "num", num) == 1);
+  assert(ARG_PARSER_GET_INT(parser, "def", def) == 1);
+  assert(ARG_PARSER_GET_BOOL(parser, "verbose", verbose) == 1);
+  assert(strcmp(name, "value") == 0);
+  assert(num == 3 && def == 5 && verbose == true);
+  arg_parser_dispose(parser);
+
+  char *err = NULL;
+  parser    = arg_parser_make(NULL);
+  ARG_PARSER_ADD_INT(parser, "num", 0, NULL, true);
+  assert(arg_parser_feed(parser, "--unknown", false, &err) == 2);
+  assert(strcmp(err, "unknown flag: --unknown") == 0);
+  free(err);
+  assert(arg_parser_feed(parser, "--num", false, NULL) == 0);
+  assert(arg_parser_feed(parser, "nan", false, NULL) == 4);
+  assert(arg_parser_finish(parser, &err) == 3);
+  assert(strcmp(err, "can't find required flag: --num") == 0);
+  free(err);
+  assert(arg_parser_feed(parser, "--num", false, NULL) == 0);
+  assert(arg_parser_finish(parser, &err) == 1);
+  assert(strcmp(err, "no value for --num") == 0);
+  free(err);
+  arg_parser_dispose(parser);
+}
+
+typedef struct _batch_result {
+  int sum;
+  int failed;
+} batch_result;
+
+int batch_callback(arg_parser *parser, int index, int result, void *data) {
+  batch_result *res = (batch_result *)data;
+  int           num = 0;
+  if (result != 0) {
+    res->failed = index;
+    return 0;
+  }
+  assert(ARG_PARSER_GET_INT(parser, "num", num) == 1);
+  res->sum += num;
+  return index == 3 ? 1 : 0;
+}
+
+void check_reset() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  ARG_PARSER_ADD_INT(parser, "num", 0, NULL, true);
+  ARG_PARSER_ADD_INTD(parser, "def", 0, NULL, 5);
+
+  int    argc    = 4;
+  char * first[] = {"program", "--num=1", "--num=2", "--def=3"};
+  char **argv    = first;
+  int    nums[4] = {0};
+  int    def     = 0;
+  int    result  = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+  assert(arg_parser_count(parser, "num") == 2);
+
+  // values of previous parsing don't pile up
+  unsigned allocs   = arg_parser_alloc_count(parser);
+  char *   second[] = {"program", "--num=4"};
+  argc              = 2;
+  argv              = second;
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+  assert(arg_parser_get_args(parser, "num", ArgInt, nums, 4) == 1);
+  assert(arg_parser_get_args(parser, "def", ArgInt, &def, 1) == 1);
+  assert(nums[0] == 4 && def == 5);
+  assert(arg_parser_alloc_count(parser) == allocs);
+
+  // required flag is checked again
+  char *third[] = {"program"};
+  argc          = 1;
+  argv          = third;
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 3);
+
+  arg_parser_reset(parser);
+  assert(arg_parser_count(parser, "def") == 0);
+
+  int          argcs[] = {2, 2, 1, 2, 2};
+  char **      argvs[] = {first, second, third, second, first};
+  batch_result res     = {0, -1};
+
+  result = arg_parser_parse_batch(parser,
+                                  5,
+                                  argcs,
+                                  argvs,
+                                  false,
+                                  batch_callback,
+                                  &res);
+  assert(result == 1); // stopped by callback after fourth command line
+  assert(res.sum == 1 + 4 + 4);
+  assert(res.failed == 2);
+  assert(arg_parser_alloc_count(parser) == allocs);
+
+  arg_parser_dispose(parser);
+}
+
+void check_reset_reuses_memory() {
+  arg_parser *parser = arg_parser_make(NULL);
+  arg_parser_set_opts(parser, ArgParserResponseFiles);
+
+  int names = ARG_PARSER_ADD_STR_LIST(parser, "names", 0, NULL, false);
+  int name  = ARG_PARSER_ADD_STR(parser, "name", 0, NULL, false);
+  int ids   = ARG_PARSER_ADD_LIST(parser,
+                                "ids",
+                                0,
+                                NULL,
+                                ArgIntList,
+                                "1,2,3",
+                                ArgDefault);
+
+  char        path[] = "/tmp/arg_parser_reuse_XXXXXX";
+  const char *file   = "--name=from-file";
+  write_file(path, file, strlen(file));
+  char response[64];
+  snprintf(response, sizeof(response), "@%s", path);
+
+  // copies of args, list values, expanded argv and mapped files of previous
+  // parsing are released by next one, so repeated parsing doesn't allocate
+  unsigned allocs = 0;
+  for (int iter = 0; iter < 1000; ++iter) {
+    int    argc   = 3;
+    char * args[] = {"program", "--names=first,second", response};
+    char **argv   = args;
+    int    result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+    assert(result == 0);
+    const char *val = NULL;
+    assert(ARG_PARSER_HGET_STR(parser, name, val) == 1);
+    assert(strcmp(val, "from-file") == 0);
+
+    arg_parser_reset(parser);
+    assert(arg_parser_feed(parser, "--names", false, NULL) == 0);
+    assert(arg_parser_feed(parser, "third,fourth", false, NULL) == 0);
+    assert(arg_parser_finish(parser, NULL) == 0);
+
+    unsigned len = 0;
+    assert(ARG_PARSER_HGET_STR_LIST(parser, names, len) && len == 2);
+    assert(ARG_PARSER_HGET_INT_LIST(parser, ids, len) && len == 3);
+    assert(ARG_PARSER_HGET_STR(parser, name, val) == 0);
+    if (iter == 10) {
+      allocs = arg_parser_alloc_count(parser);
+    }
+  }
+  assert(arg_parser_alloc_count(parser) == allocs);
+  unlink(path);
+
+  arg_parser_dispose(parser);
+}
+
+void check_results() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  int name = ARG_PARSER_ADD_STR(parser, "name", 'n', NULL, true);
+  int num  = ARG_PARSER_ADD_INTD(parser, "num", 0, NULL, 1);
+
+  arg_result *first  = arg_result_make();
+  arg_result *second = arg_result_make();
+
+  // nothing parsed yet
+  assert(arg_result_hcount(parser, first, name) == 0);
+
+  int    argc     = 3;
+  char * args_a[] = {"program", "--name=a", "--num=2"};
+  char **argv     = args_a;
+  int    result   = arg_parser_parse_into(parser,
+                                     first,
+                                     &argc,
+                                     &argv,
+                                     false,
+                                     false,
+                                     NULL);
+  assert(result == 0);
+
+  char *args_b[] = {"program", "-n", "b"};
+  argv           = args_b;
+  result         = arg_parser_parse_into(parser,
+                                 second,
+                                 &argc,
+                                 &argv,
+                                 false,
+                                 false,
+                                 NULL);
+  assert(result == 0);
+
+  // results are independent and parser own result is not touched
+  const char *str = NULL;
+  int         val = 0;
+  assert(ARG_RESULT_HGET_STR(parser, first, name, str) == 1);
+  assert(strcmp(str, "a") == 0);
+  assert(ARG_RESULT_GET_INT(parser, first, "num", val) == 1 && val == 2);
+  assert(ARG_RESULT_GET_STR(parser, second, "name", str) == 1);
+  assert(strcmp(str, "b") == 0);
+  assert(ARG_RESULT_HGET_INT(parser, second, num, val) == 1 && val == 1);
+  assert(arg_result_count(parser, second, "name") == 1);
+  assert(arg_parser_hcount(parser, name) == 0);
+
+  arg_result_reset(parser, first);
+  assert(arg_parser_feed_into(parser, first, "--num", false, NULL) == 0);
+  assert(arg_parser_feed_into(parser, first, "5", false, NULL) == 0);
+  assert(arg_parser_finish_into(parser, first, NULL) == 3);
+  arg_result_reset(parser, first);
+  assert(arg_parser_feed_into(parser, first, "--name=c", false, NULL) == 0);
+  assert(arg_parser_finish_into(parser, first, NULL) == 0);
+  assert(arg_result_hget_last(parser, first, name, ArgString, &str) == 1);
+  assert(strcmp(str, "c") == 0);
+
+  arg_result_dispose(first);
+  arg_result_dispose(second);
+  arg_parser_dispose(parser);
+}
+
+void check_parse_many() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  int num = ARG_PARSER_ADD_INT(parser, "num", 'n', NULL, true);
+  ARG_PARSER_ADD_STRD(parser, "name", 0, NULL, "default");
+
+  enum { JobCount = 1000 };
+  static char  data[JobCount][2][32];
+  static char *args[JobCount][3];
+  char **      argvs[JobCount];
+  int          argcs[JobCount];
+  arg_result   results[JobCount];
+  for (int i = 0; i < JobCount; ++i) {
+    snprintf(data[i][0], sizeof(data[i][0]), "--num=%d", i);
+    snprintf(data[i][1], sizeof(data[i][1]), "--name=%d", i);
+    args[i][0] = "program";
+    args[i][1] = data[i][0];
+    args[i][2] = data[i][1];
+    argvs[i]   = args[i];
+    argcs[i]   = i % 10 == 0 ? 1 : (i % 2 ? 2 : 3); // every 10th has no num
+    arg_result_init(&results[i]);
+  }
+
+  // results are cleared, so stale values of previous iteration can't pass,
+  // without threads all jobs are parsed by calling thread for any nthreads
+  int nthreads[] = {1, 4, 0};
+  for (unsigned iter = 0; iter < sizeof(nthreads) / sizeof(int); ++iter) {
+    for (int i = 0; i < JobCount; ++i) {
+      arg_result_release(&results[i]);
+      arg_result_init(&results[i]);
+      results[i].code = -1;
+    }
+    int failed = arg_parser_parse_many(parser,
+                                       JobCount,
+                                       argcs,
+                                       argvs,
+                                       results,
+                                       nthreads[iter]);
+    assert(failed == JobCount / 10);
+
+    for (int i = 0; i < JobCount; ++i) {
+      const char *name = NULL;
+      int         val  = -1;
+      if (i % 10 == 0) {
+        assert(results[i].code == 3);
+        assert(strcmp(results[i].err, "can't find required flag: --num") ==
+               0);
+        continue;
+      }
+
+      assert(results[i].code == 0 && results[i].err == NULL);
+      assert(ARG_RESULT_HGET_INT(parser, &results[i], num, val) == 1);
+      assert(ARG_RESULT_GET_STR(parser, &results[i], "name", name) == 1);
+      assert(val == i);
+      assert(strcmp(name, i % 2 ? "default" : data[i][1] + 7) == 0);
+    }
+  }
+
+  for (int i = 0; i < JobCount; ++i) {
+    arg_result_release(&results[i]);
+  }
+  arg_parser_dispose(parser);
+}
+
+
+void check_numbers() {
+  union ArgUnion val;
+
+  // clang-format off
+  const char *ints[]     = {"0", "-0", "+7", "  42", "0x1F", "0X1f", "017",
+                            "2147483647", "-2147483648", "-0x80000000"};
+  int         int_vals[] = {0, 0, 7, 42, 31, 31, 15,
+                            2147483647, -2147483647 - 1, -2147483647 - 1};
+  const char *bad_ints[] = {"", "-", "0x", "08", "1 ", "12a", "2147483648",
+                            "-2147483649", "0x80000000", "99999999999",
+                            "+-1", "1.5"};
+  // clang-format on
+  for (unsigned i = 0; i < sizeof(ints) / sizeof(ints[0]); ++i) {
+    assert(arg_val_from_str(ArgInt, ints[i], &val) == 0);
+    assert(val.val_int == int_vals[i]);
+  }
+  for (unsigned i = 0; i < sizeof(bad_ints) / sizeof(bad_ints[0]); ++i) {
+    assert(arg_val_from_str(ArgInt, bad_ints[i], &val) != 0);
+  }
+
+  // long chains of digits are parsed by 8 digits at once
+  assert(arg_val_from_str(ArgLongLong, "9223372036854775807", &val) == 0);
+  assert(val.val_ll == LLONG_MAX);
+  assert(arg_val_from_str(ArgLongLong, "-9223372036854775808", &val) == 0);
+  assert(val.val_ll == LLONG_MIN);
+  assert(arg_val_from_str(ArgLongLong, "+1234567890123456", &val) == 0);
+  assert(val.val_ll == 1234567890123456ll);
+  assert(arg_val_from_str(ArgLongLong, "9223372036854775808", &val) != 0);
+  assert(arg_val_from_str(ArgLongLong, "12345678901234567890", &val) != 0);
+  assert(arg_val_from_str(ArgLongLong, "1234567890123x", &val) != 0);
+  assert(arg_val_from_str(ArgLong, "-12345678", &val) == 0);
+  assert(val.val_long == -12345678);
+
+  assert(arg_val_from_str(ArgBool, "0x10", &val) == 0 && val.val_bool);
+  assert(arg_val_from_str(ArgBool, "0", &val) == 0 && !val.val_bool);
+  assert(arg_val_from_str(ArgBool, "yes", &val) != 0);
+
+  // same values as strtod, exact fast path and fallback
+  // clang-format off
+  const char *doubles[] = {"0", "-0.0", "1", "-1.5", "3.14159", ".5", "5.",
+                           "1e10", "1E-5", "+2.5e+3", "0.1", "0.3",
+                           "123456789012345678", "9007199254740993",
+                           "1.7976931348623157e308", "4.9e-324", "1e23",
+                           "0.000000000000000000000000001", "inf", "-nan",
+                           "0x1p3", "  7.25", "12345678901234567890123"};
+  const char *bad_doubles[] = {"", ".", "-", "1e", "1e+", "1.5x", "1 ",
+                               "e5", "1.2.3"};
+  // clang-format on
+  for (unsigned i = 0; i < sizeof(doubles) / sizeof(doubles[0]); ++i) {
+    double expected = strtod(doubles[i], NULL);
+    assert(arg_val_from_str(ArgDouble, doubles[i], &val) == 0);
+    assert(memcmp(&val.val_double, &expected, sizeof(double)) == 0 ||
+           (expected != expected && val.val_double != val.val_double));
+  }
+  for (unsigned i = 0; i < sizeof(bad_doubles) / sizeof(bad_doubles[0]);
+       ++i) {
+    assert(arg_val_from_str(ArgDouble, bad_doubles[i], &val) != 0);
+  }
+
+  // no locale with `,` as decimal point is guaranteed to be installed, so
+  // locale dependent fallback is checked with explicitly given point
+  {
+    char        longnum[2 * ARG_MAX_NUM_LEN];
+    const char *precise = "0.12345678901234567891";
+    double      d       = 0;
+    memset(longnum, '0', sizeof(longnum) - 1);
+    longnum[1]                   = '.';
+    longnum[sizeof(longnum) - 2] = '1';
+    longnum[sizeof(longnum) - 1] = '\0';
+
+    assert(arg_strtod(precise, precise + strlen(precise), ".", &d) == 0);
+    assert(d == strtod(precise, NULL));
+    assert(arg_strtod("1,5", "1,5" + 3, ",", &d) != 0);
+    assert(arg_strtod("1,5", "1,5" + 3, ".", &d) != 0);
+    assert(arg_strtod("1e300", "1e300" + 5, ",", &d) == 0);
+    assert(d == 1e300);
+    // `.` is replaced by `,`, which isn't decimal point of "C" locale
+    assert(arg_strtod("1.5", "1.5" + 3, ",", &d) != 0);
+    assert(arg_strtod(longnum, longnum + strlen(longnum), ".", &d) == 0);
+    assert(d == strtod(longnum, NULL));
+    assert(arg_strtod(longnum, longnum + strlen(longnum), ",", &d) != 0);
+  }
+}
+
+
+void check_kept_args() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  ARG_PARSER_ADD_INT(parser, "num", 'n', NULL, false);
+  ARG_PARSER_ADD_BOOL(parser, "verbose", 'v', NULL, false);
+
+  // clang-format off
+  char *args[] = {"program",
+                  "first",
+                  "-n", "1",
+                  "--unknown",
+                  "second",
+                  "-v",
+                  "--num=2",
+                  "third"};
+  // clang-format on
+  int    argc    = sizeof(args) / sizeof(args[0]);
+  char **argv    = args;
+  int    kept[9] = {0};
+  int    count   = 0;
+  int    result  = arg_parser_parse_kept(parser,
+                                     &parser->res,
+                                     &argc,
+                                     &argv,
+                                     true,
+                                     kept,
+                                     9,
+                                     &count,
+                                     NULL);
+  assert(result == 0);
+  assert(argc == 9 && argv == args); // argv is not changed
+  assert(count == 4);
+  assert(kept[0] == 0 && kept[1] == 1 && kept[2] == 5 && kept[3] == 8);
+  assert(arg_parser_count(parser, "num") == 2);
+
+  // compaction keeps same args in same order
+  result = ARG_PARSER_PARSE(parser, argc, argv, true, true, NULL);
+  assert(result == 0);
+  assert(argc == 4);
+  for (int i = 0; i < argc; ++i) {
+    assert(argv[i] == args[kept[i]]);
+  }
+
+  // long command line
+  enum { ArgCount = 30001 };
+  static char *long_args[ArgCount];
+  const char * pattern[] = {"positional", "-v", "--num=1"};
+  long_args[0]           = "program";
+  for (int i = 1; i < ArgCount; ++i) {
+    long_args[i] = (char *)pattern[i % 3];
+  }
+  argc   = ArgCount;
+  argv   = long_args;
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, true, NULL);
+  assert(result == 0);
+  assert(argc == 1 + ArgCount / 3);
+  assert(strcmp(argv[argc - 1], "positional") == 0);
+  assert(arg_parser_count(parser, "verbose") == ArgCount / 3);
+
+  // response file adds args, indices refer to expanded argv and not more
+  // than size of kept are written
+  char        path[] = "/tmp/arg_parser_kept_XXXXXX";
+  const char *file   = "a b c d e f";
+  write_file(path, file, strlen(file));
+  char response[64];
+  snprintf(response, sizeof(response), "@%s", path);
+  arg_parser_set_opts(parser, ArgParserResponseFiles);
+
+  char *short_args[] = {"program", response, "last"};
+  int   small[3]     = {-1, -1, -1};
+  argc               = 3;
+  argv               = short_args;
+
+  result = arg_parser_parse_kept(parser,
+                                 &parser->res,
+                                 &argc,
+                                 &argv,
+                                 false,
+                                 small,
+                                 2,
+                                 &count,
+                                 NULL);
+  assert(result == 0);
+  assert(argc == 8 && count == 8);
+  assert(small[0] == 0 && small[1] == 1 && small[2] == -1);
+  assert(strcmp(argv[1], "a") == 0 && strcmp(argv[7], "last") == 0);
+  unlink(path);
+
+  arg_parser_dispose(parser);
+}
+
+
+int count_chunks(void *data, const char *str, size_t len) {
+  (void)str;
+  *(size_t *)data += len;
+  return 0;
+}
+
+void check_usage_writer() {
+  arg_parser *parser = arg_parser_make("desc");
+
+  char long_name[300];
+  memset(long_name, 'a', sizeof(long_name) - 1);
+  long_name[sizeof(long_name) - 1] = '\0';
+  ARG_PARSER_ADD_INT(parser, "num", 'n', "number", false);
+  ARG_PARSER_ADD_DOUBLED(parser, "big", 0, "big default", 1e300);
+
+  // cached usage is same until schema changes
+  const char *cached = arg_parser_usage_cached(parser);
+  assert(cached == arg_parser_usage_cached(parser));
+  ARG_PARSER_ADD_STRD(parser, long_name, 0, "long name", "x");
+  cached = arg_parser_usage_cached(parser);
+  assert(cached == arg_parser_usage_cached(parser));
+
+  // long lines are not truncated
+  size_t len = arg_parser_usage_to(parser, NULL, 0);
+  assert(len == strlen(cached));
+  assert(strstr(cached, long_name) != NULL);
+  assert(strstr(cached, "(=1000000000000000052504760255204420248704468581") !=
+         NULL);
+
+  char small[8];
+  assert(arg_parser_usage_to(parser, small, sizeof(small)) == len);
+  assert(strcmp(small, "desc\n  ") == 0);
+
+  size_t total = 0;
+  assert(arg_parser_usage_write(parser, count_chunks, &total) == 0);
+  assert(total == len);
+
+  char *usage = arg_parser_usage(parser);
+  assert(strcmp(usage, cached) == 0);
+  free(usage);
+
+  arg_parser_dispose(parser);
+}
+
+
+void check_env() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  int level = ARG_PARSER_ADD_ARG(parser, "log_level", 0, NULL, int, 0, ArgEnv);
+  int name  = ARG_PARSER_ADD_ARG(parser,
+                                "name",
+                                0,
+                                NULL,
+                                str,
+                                NULL,
+                                ArgEnv | ArgRequired);
+  int def   = ARG_PARSER_ADD_ARG(parser,
+                                "def",
+                                0,
+                                NULL,
+                                int,
+                                5,
+                                ArgEnv | ArgDefault);
+  int other = ARG_PARSER_ADD_INTD(parser, "other", 0, NULL, 1);
+
+  char *envp[] = {"APP_LOG_LEVEL=3",
+                  "APP_NAME=env",
+                  "APP_NAME=second",
+                  "APP_OTHER=2",
+                  "OTHER_DEF=7",
+                  "APP_=empty",
+                  NULL};
+  arg_parser_set_env(parser, "APP_", envp);
+
+  // values from argv have priority, required flag is set by environment
+  int    argc   = 2;
+  char * args[] = {"program", "--log-level=4"};
+  char **argv   = args;
+  int    result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+
+  const char *str = NULL;
+  int         val = 0;
+  assert(ARG_PARSER_HGET_INT(parser, level, val) == 1 && val == 4);
+  assert(ARG_PARSER_HGET_STR(parser, name, str) == 1);
+  assert(strcmp(str, "env") == 0);
+  assert(ARG_PARSER_HGET_INT(parser, def, val) == 1 && val == 5);
+  assert(ARG_PARSER_HGET_INT(parser, other, val) == 1 && val == 1);
+
+  // all args can be set by environment
+  arg_parser_set_opts(parser, ArgParserEnvAll);
+  argc   = 1;
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+  assert(ARG_PARSER_HGET_INT(parser, level, val) == 1 && val == 3);
+  assert(ARG_PARSER_HGET_INT(parser, other, val) == 1 && val == 2);
+
+  char *bad_envp[] = {"APP_LOG_LEVEL=high", NULL};
+  char *err        = NULL;
+  arg_parser_set_env(parser, "APP_", bad_envp);
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, false, &err);
+  assert(result == 4);
+  assert(strcmp(err, "can't convert: APP_LOG_LEVEL high") == 0);
+  free(err);
+
+  // required flag without variable
+  arg_parser_set_opts(parser, ArgParserNone);
+  arg_parser_set_env(parser, "APP_", NULL);
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 3);
+
+  arg_parser_dispose(parser);
+}
+
+
+void check_config_file() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  int name    = ARG_PARSER_ADD_STR(parser, "name", 0, NULL, true);
+  int num     = ARG_PARSER_ADD_INTD(parser, "num", 0, NULL, 1);
+  int level   = ARG_PARSER_ADD_ARG(parser, "level", 0, NULL, int, 0, ArgEnv);
+  int verbose = ARG_PARSER_ADD_BOOL(parser, "verbose", 0, NULL, false);
+  int def     = ARG_PARSER_ADD_DOUBLED(parser, "def", 0, NULL, 2.5);
+
+  char        path[] = "/tmp/arg_parser_config_XXXXXX";
+  const char *config = "# comment\n"
+                       "\n"
+                       "  NAME = \"hello world\"  \n"
+                       "num=5\n"
+                       "num = 6\n"
+                       "Level=7\n"
+                       "verbose";
+  write_file(path, config, strlen(config));
+  assert(arg_parser_load_file(parser, path, NULL) == 0);
+
+  char *envp[] = {"APP_LEVEL=8", NULL};
+  arg_parser_set_env(parser, "APP_", envp);
+
+  // precedence: defaults < file < env < argv
+  int    argc   = 2;
+  char * args[] = {"program", "--num=9"};
+  char **argv   = args;
+  int    result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+
+  const char *str = NULL;
+  int         val = 0;
+  bool        on  = false;
+  double      dbl = 0;
+  assert(ARG_PARSER_HGET_STR(parser, name, str) == 1);
+  assert(strcmp(str, "hello world") == 0);
+  assert(ARG_PARSER_HGET_INT(parser, num, val) == 1 && val == 9);
+  assert(ARG_PARSER_HGET_INT(parser, level, val) == 1 && val == 8);
+  assert(ARG_PARSER_HGET_BOOL(parser, verbose, on) == 1 && on);
+  assert(ARG_PARSER_HGET_DOUBLE(parser, def, dbl) == 1 && dbl == 2.5);
+
+  // without argv values all values of file are used
+  argc   = 1;
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+  int nums[2] = {0};
+  assert(arg_parser_hget_args(parser, num, ArgInt, nums, 2) == 2);
+  assert(nums[0] == 5 && nums[1] == 6);
+  unlink(path);
+
+  char *      err        = NULL;
+  char        bad[]      = "/tmp/arg_parser_bad_XXXXXX";
+  const char *contents[] = {"num = 10\nunknown = 1",
+                            "num = 10\nnum = x",
+                            "num = 10\nnum"};
+  int         codes[]    = {2, 4, 1};
+  for (int i = 0; i < 3; ++i) {
+    strcpy(bad, "/tmp/arg_parser_bad_XXXXXX");
+    write_file(bad, contents[i], strlen(contents[i]));
+    assert(arg_parser_load_file(parser, bad, &err) == codes[i]);
+    free(err);
+    unlink(bad);
+  }
+
+  // values before error in failed file are not applied
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+  assert(arg_parser_hget_args(parser, num, ArgInt, nums, 2) == 2);
+  assert(arg_parser_hcount(parser, num) == 2);
+  assert(nums[0] == 5 && nums[1] == 6);
+  assert(arg_parser_load_file(parser, "/nonexistent/config", &err) == 5);
+  assert(strcmp(err, "can't read file: /nonexistent/config") == 0);
+  free(err);
+  arg_parser_dispose(parser);
+
+  // empty list of config satisfies required flag, unless the file failed
+  const char *lists[]   = {"ids =\nunknown = 1", "ids ="};
+  int         results[] = {3, 0};
+  parser                = arg_parser_make(NULL);
+  ARG_PARSER_ADD_INT_LIST(parser, "ids", 0, NULL, true);
+  for (int i = 0; i < 2; ++i) {
+    strcpy(bad, "/tmp/arg_parser_bad_XXXXXX");
+    write_file(bad, lists[i], strlen(lists[i]));
+    arg_parser_load_file(parser, bad, NULL);
+    unlink(bad);
+    argc   = 1;
+    argv   = args;
+    result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+    assert(result == results[i]);
+  }
+  arg_parser_dispose(parser);
+}
+
+
+void build_commit(arg_parser *parser, void *data) {
+  ++*(int *)data;
+  ARG_PARSER_ADD_STR(parser, "message", 'm', "commit message", true);
+  ARG_PARSER_ADD_BOOL(parser, "all", 'a', "commit all", false);
+}
+
+void build_push(arg_parser *parser, void *data) {
+  ++*(int *)data;
+  ARG_PARSER_ADD_BOOL(parser, "force", 'f', "force push", false);
+}
+
+void check_subcommands() {
+  arg_parser *parser  = arg_parser_make(NULL);
+  int         commits = 0;
+  int         pushes  = 0;
+
+  int verbose = ARG_PARSER_ADD_BOOL(parser, "verbose", 'v', "verbose", false);
+  int commit  = arg_parser_add_cmd(parser,
+                                  "commit",
+                                  "record changes",
+                                  build_commit,
+                                  &commits);
+  int push    = arg_parser_add_cmd(parser,
+                                "push",
+                                "update remote",
+                                build_push,
+                                &pushes);
+
+  const char *target_usage = "  -v, --verbose verbose\n"
+                             "commands:\n"
+                             "  commit        record changes\n"
+                             "  push          update remote\n";
+  assert(strcmp(arg_parser_usage_cached(parser), target_usage) == 0);
+
+  // bool flag doesn't take subcommand as value, only chosen command is built
+  int    argc   = 7;
+  char * args[] = {"program", "file", "-v", "commit", "-m", "msg", "tail"};
+  char **argv   = args;
+  int    result = ARG_PARSER_PARSE(parser, argc, argv, false, true, NULL);
+  assert(result == 0);
+  assert(arg_parser_cmd(parser) == commit);
+  assert(commits == 1 && pushes == 0);
+  assert(argc == 4);
+  assert(strcmp(argv[1], "file") == 0);
+  assert(strcmp(argv[2], "commit") == 0);
+  assert(strcmp(argv[3], "tail") == 0);
+
+  bool        on  = false;
+  const char *str = NULL;
+  assert(ARG_PARSER_HGET_BOOL(parser, verbose, on) == 1 && on);
+  arg_parser *sub = arg_parser_cmd_parser(parser, commit);
+  assert(ARG_PARSER_GET_STR(sub, "message", str) == 1);
+  assert(strcmp(str, "msg") == 0);
+
+  // flags of subcommand are unknown for parent and vice versa
+  char *err = NULL;
+  argc      = 3;
+  argv      = args;
+  args[1]   = "-m";
+  args[2]   = "msg";
+  result    = ARG_PARSER_PARSE(parser, argc, argv, false, false, &err);
+  assert(result == 2);
+  free(err);
+
+  char *push_args[] = {"program", "push", "-v"};
+  argc              = 3;
+  argv              = push_args;
+  result            = ARG_PARSER_PARSE(parser, argc, argv, false, false, &err);
+  assert(result == 2);
+  assert(strcmp(err, "unknown flag: -v") == 0);
+  assert(arg_parser_cmd(parser) == push);
+  assert(pushes == 1);
+  free(err);
+
+  // parsing into result stops at subcommand
+  arg_result *res = arg_result_make();
+  int         pos = 0;
+  argc            = 3;
+  argv            = push_args;
+
+  result = arg_parser_parse_into(parser, res, &argc, &argv, false, false, NULL);
+  assert(result == 0);
+  assert(arg_result_cmd(res, &pos) == push && pos == 1);
+  arg_result_dispose(res);
+
+  // command is built once
+  assert(arg_parser_cmd_parser(parser, commit) == sub);
+  assert(arg_parser_cmd_parser(parser, 2) == NULL);
+  assert(commits == 1);
+
+  argc    = 2;
+  argv    = args;
+  args[1] = "file";
+  result  = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0 && arg_parser_cmd(parser) == -1);
+
+  arg_parser_dispose(parser);
+}
+
+
+/**\brief run completion query and return printed names
+ */
+const char *complete(arg_parser *parser, int index, int count, char *words[]) {
+  static char buf[256];
+  FILE *      out  = tmpfile();
+  int         size = arg_parser_complete(parser, index, count, words, out);
+  rewind(out);
+  buf[fread(buf, 1, sizeof(buf) - 1, out)] = '\0';
+  fclose(out);
+  assert(size >= 0);
+  return buf;
+}
+
+void check_completion() {
+  arg_parser *parser  = arg_parser_make(NULL);
+  int         commits = 0;
+  int         pushes  = 0;
+
+  ARG_PARSER_ADD_BOOL(parser, "verbose", 'v', NULL, false);
+  ARG_PARSER_ADD_BOOL(parser, "Version", 0, NULL, false);
+  ARG_PARSER_ADD_STR(parser, "value", 0, NULL, false);
+  ARG_PARSER_ADD_INT(parser, "jobs", 'j', NULL, false);
+  arg_parser_add_cmd(parser, "config", NULL, build_push, &pushes);
+  arg_parser_add_cmd(parser, "commit", NULL, build_commit, &commits);
+
+  char *flags[] = {"prog", "--ver"};
+  assert(strcmp(complete(parser, 1, 2, flags), "--verbose\n--version\n") ==
+         0);
+  flags[1]       = "--V";
+  const char *vs = "--value\n--verbose\n--version\n";
+  assert(strcmp(complete(parser, 1, 2, flags), vs) == 0);
+  flags[1]        = "-";
+  const char *all = "--jobs\n--value\n--verbose\n--version\n";
+  assert(strcmp(complete(parser, 1, 2, flags), all) == 0);
+  flags[1] = "--x";
+  assert(strcmp(complete(parser, 1, 2, flags), "") == 0);
+
+  // subcommands are completed by positional words
+  char *cmds[] = {"prog", "-v", "co"};
+  assert(strcmp(complete(parser, 2, 3, cmds), "commit\nconfig\n") == 0);
+  assert(strcmp(complete(parser, 3, 3, cmds), "commit\nconfig\n") == 0);
+
+  // value of flag is completed by shell
+  char *vals[] = {"prog", "--value", "co"};
+  assert(strcmp(complete(parser, 2, 3, vals), "") == 0);
+
+  // flags of chosen subcommand only
+  char *sub[] = {"prog", "--jobs", "commit", "commit", "--"};
+  assert(strcmp(complete(parser, 4, 5, sub), "--all\n--message\n") == 0);
+  assert(commits == 1 && pushes == 0);
+
+  // built-in mode
+  char *  err    = NULL;
+  char *  args[] = {"prog", "--__complete", "1", "prog", "--x"};
+  char ** argv   = args;
+  int     argc   = 5;
+  arg_parser_set_opts(parser, ArgParserCompletion);
+  int result = ARG_PARSER_PARSE(parser, argc, argv, false, false, &err);
+  assert(result == 6);
+  free(err);
+
+  FILE *out = tmpfile();
+  char  script[1024];
+  assert(arg_complete_script("my-prog", ArgShellBash, out) == 0);
+  rewind(out);
+  script[fread(script, 1, sizeof(script) - 1, out)] = '\0';
+  fclose(out);
+  assert(strstr(script, "--__complete"));
+  assert(strstr(script, "complete -o default -F _my_prog_complete my-prog\n"));
+
+  arg_parser_dispose(parser);
+}
+
+
+void check_abbrev_and_suggestions() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  int verbose = ARG_PARSER_ADD_BOOL(parser, "verbose", 'v', NULL, false);
+  ARG_PARSER_ADD_BOOL(parser, "version", 0, NULL, false);
+  int jobs = ARG_PARSER_ADD_INT(parser, "jobs", 'j', NULL, false);
+  ARG_PARSER_ADD_STR(parser, "output", 'o', NULL, false);
+  ARG_PARSER_ADD_STR(parser, "out-dir", 0, NULL, false);
+  for (int i = 0; i < 100; ++i) {
+    char name[32];
+    snprintf(name, sizeof(name), "flag-%i", i);
+    ARG_PARSER_ADD_INT(parser, name, 0, NULL, false);
+  }
+
+  // prefixes are accepted only with option
+  char * err    = NULL;
+  int    argc   = 3;
+  char * args[] = {"program", "--verb", "--jo=4"};
+  char **argv   = args;
+  int    result = ARG_PARSER_PARSE(parser, argc, argv, false, false, &err);
+  assert(result == 2);
+  assert(strcmp(err, "unknown flag: --verb, did you mean --verbose?") == 0);
+  free(err);
+
+  arg_parser_set_opts(parser, ArgParserAbbrev);
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+  bool on  = false;
+  int  val = 0;
+  assert(ARG_PARSER_HGET_BOOL(parser, verbose, on) == 1 && on);
+  assert(ARG_PARSER_HGET_INT(parser, jobs, val) == 1 && val == 4);
+
+  // full name is preferred to longer names with same prefix
+  args[2] = "--flag-1=1";
+  result  = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+  assert(ARG_PARSER_GET_INT(parser, "flag-1", val) == 1 && val == 1);
+
+  // names with prefix or close names are suggested
+  const char *hints[][2] = {
+      {"--ver", "unknown flag: --ver, did you mean --verbose, --version?"},
+      {"--verbos_e", "unknown flag: --verbos_e, did you mean --verbose?"},
+      {"--jbos", "unknown flag: --jbos, did you mean --jobs?"},
+      {"--outptu=x", "unknown flag: --outptu=x, did you mean --output?"},
+      {"--flag-5x", "unknown flag: --flag-5x, did you mean --flag-5, "
+                    "--flag-50, --flag-51?"},
+      {"--nothing", "unknown flag: --nothing"},
+      {"-x", "unknown flag: -x"},
+  };
+  argc = 2;
+  for (unsigned i = 0; i < sizeof(hints) / sizeof(hints[0]); ++i) {
+    args[1] = (char *)hints[i][0];
+    result  = ARG_PARSER_PARSE(parser, argc, argv, false, false, &err);
+    assert(result == 2);
+    assert(strcmp(err, hints[i][1]) == 0);
+    free(err);
+  }
+
+  assert(arg_parser_feed(parser, "--jbos", false, &err) == 2);
+  assert(strcmp(err, "unknown flag: --jbos, did you mean --jobs?") == 0);
+  free(err);
+
+  // very long unknown name is too far from any name to search
+  size_t len  = 200000;
+  char * huge = (char *)malloc(len + 1);
+  memset(huge, 'x', len);
+  memcpy(huge, "--", 2);
+  huge[len] = '\0';
+  args[1]   = huge;
+  result    = ARG_PARSER_PARSE(parser, argc, argv, false, false, &err);
+  assert(result == 2 && strstr(err, "did you mean") == NULL);
+  free(err);
+  free(huge);
+
+  arg_parser_dispose(parser);
+}
+
+
+void check_short_clusters() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  int all   = ARG_PARSER_ADD_BOOL(parser, "all", 'a', NULL, false);
+  int brief = ARG_PARSER_ADD_BOOL(parser, "brief", 'b', NULL, false);
+  int jobs  = ARG_PARSER_ADD_INT(parser, "jobs", 'j', NULL, false);
+  int name  = ARG_PARSER_ADD_STR(parser, "name", 'n', NULL, false);
+
+  int    argc   = 6;
+  char * args[] = {"program", "-abj8", "-n", "x", "-bn=y", "-ajn"};
+  char **argv   = args;
+  int    result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 4); // `n` is value of `j` in `-ajn`
+
+  argc   = 5;
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+  assert(arg_parser_hcount(parser, all) == 1);
+  assert(arg_parser_hcount(parser, brief) == 2);
+
+  int         vals[2] = {0};
+  const char *strs[2] = {NULL};
+  assert(arg_parser_hget_args(parser, jobs, ArgInt, vals, 2) == 1);
+  assert(vals[0] == 8);
+  assert(arg_parser_hget_args(parser, name, ArgString, strs, 2) == 2);
+  assert(strcmp(strs[0], "x") == 0 && strcmp(strs[1], "y") == 0);
+
+  // last flag of cluster takes next arg, attached string value
+  char *more[] = {"program", "-baj", "16", "-nvalue"};
+  argc         = 4;
+  argv         = more;
+  result       = ARG_PARSER_PARSE(parser, argc, argv, false, true, NULL);
+  assert(result == 0 && argc == 1);
+  assert(ARG_PARSER_HGET_INT(parser, jobs, vals[0]) == 1 && vals[0] == 16);
+  assert(ARG_PARSER_HGET_STR(parser, name, strs[0]) == 1);
+  assert(strcmp(strs[0], "value") == 0);
+
+  // cluster with unknown name is unknown as a whole
+  char *err   = NULL;
+  char *bad[] = {"program", "-abx"};
+  argc        = 2;
+  argv        = bad;
+  result      = ARG_PARSER_PARSE(parser, argc, argv, false, false, &err);
+  assert(result == 2);
+  assert(strcmp(err, "unknown flag: -abx") == 0);
+  free(err);
+  result = ARG_PARSER_PARSE(parser, argc, argv, true, false, NULL);
+  assert(result == 0);
+  assert(arg_parser_hcount(parser, all) == 0);
+
+  // feed mode
+  assert(arg_parser_feed(parser, "-abj", false, NULL) == 0);
+  assert(arg_parser_feed(parser, "3", false, NULL) == 0);
+  assert(arg_parser_finish(parser, NULL) == 0);
+  assert(arg_parser_hcount(parser, brief) == 1);
+  assert(ARG_PARSER_HGET_INT(parser, jobs, vals[0]) == 1 && vals[0] == 3);
+
+  arg_parser_dispose(parser);
+}
+
+
+void check_list_args() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  int ids   = ARG_PARSER_ADD_INT_LIST(parser, "ids", 'i', NULL, true);
+  int names = ARG_PARSER_ADD_STR_LIST(parser, "names", 0, NULL, false);
+  int big   = ARG_PARSER_ADD_LL_LIST(parser, "big", 0, NULL, false);
+  int dbls  = ARG_PARSER_ADD_LIST(parser,
+                                 "dbls",
+                                 0,
+                                 "doubles",
+                                 ArgDoubleList,
+                                 "0.5,1.5",
+                                 ArgDefault);
+  int empty = ARG_PARSER_ADD_LONG_LIST(parser, "empty", 0, NULL, false);
+
+  const char *usage = arg_parser_usage_cached(parser);
+  assert(strstr(usage, "\n      --dbls (=0.5,1.5) doubles\n"));
+
+  // values of repeated flags are appended to same array
+  int    argc   = 8;
+  char * args[] = {"program",
+                   "--ids",
+                   "1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17",
+                   "-i=-18",
+                   "--names=first,second,,a rather long name without commas",
+                   "--big=9223372036854775807,-9223372036854775808",
+                   "--empty",
+                   ""};
+  char **argv   = args;
+  int    result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+
+  unsigned   len  = 0;
+  const int *vals = ARG_PARSER_HGET_INT_LIST(parser, ids, len);
+  assert(len == 18);
+  for (int i = 0; i < 17; ++i) {
+    assert(vals[i] == i + 1);
+  }
+  assert(vals[17] == -18);
+  assert(arg_parser_hcount(parser, ids) == 18);
+
+  const char *const *strs = ARG_PARSER_HGET_STR_LIST(parser, names, len);
+  assert(len == 4);
+  assert(strcmp(strs[0], "first") == 0 && strcmp(strs[1], "second") == 0);
+  assert(strcmp(strs[2], "") == 0);
+  assert(strcmp(strs[3], "a rather long name without commas") == 0);
+  assert(strchr(args[4], ',') && "argv is not changed");
+
+  const long long *lls = ARG_PARSER_HGET_LL_LIST(parser, big, len);
+  assert(len == 2 && lls[0] == LLONG_MAX && lls[1] == LLONG_MIN);
+
+  const double *dbl = ARG_PARSER_HGET_DOUBLE_LIST(parser, dbls, len);
+  assert(len == 2 && dbl[0] == 0.5 && dbl[1] == 1.5);
+
+  assert(ARG_PARSER_HGET_LONG_LIST(parser, empty, len) == NULL && len == 0);
+  assert(arg_parser_hget_list(parser, ids, ArgInt, &len) == NULL);
+
+  // getter by copying works for lists too
+  int first[2] = {0};
+  assert(arg_parser_hget_args(parser, ids, ArgIntList, first, 2) == 2);
+  assert(first[0] == 1 && first[1] == 2);
+
+  char *err = NULL;
+  char *bad_args[][2] = {{"program", "--ids=1,2,x"},
+                         {"program", "--ids=1,,2"},
+                         {"program", "--ids=1,99999999999"}};
+  for (int i = 0; i < 3; ++i) {
+    argc   = 2;
+    argv   = bad_args[i];
+    result = ARG_PARSER_PARSE(parser, argc, argv, false, false, &err);
+    assert(result == 4);
+    free(err);
+  }
+
+  // list values from result
+  arg_result *res = arg_result_make();
+  argc            = 3;
+  argv            = args;
+  result = arg_parser_parse_into(parser, res, &argc, &argv, false, false, NULL);
+  assert(result == 0);
+  vals = ARG_RESULT_HGET_INT_LIST(parser, res, ids, len);
+  assert(len == 17 && vals[16] == 17);
+
+  // explicitly empty list is found, so neither required flag is missing nor
+  // default is used
+  char *empty_args[] = {"program", "--ids=", "--dbls="};
+  argc               = 3;
+  argv               = empty_args;
+  result = arg_parser_parse_into(parser, res, &argc, &argv, false, false, NULL);
+  assert(result == 0);
+  assert(ARG_RESULT_HGET_INT_LIST(parser, res, ids, len) == NULL && len == 0);
+  assert(ARG_RESULT_HGET_DOUBLE_LIST(parser, res, dbls, len) == NULL);
+  argc   = 1;
+  argv   = empty_args;
+  result = arg_parser_parse_into(parser, res, &argc, &argv, false, false, NULL);
+  assert(result == 3 && "seen flag is cleared by next parsing");
+  arg_result_dispose(res);
+
+  arg_parser_dispose(parser);
+}
+
+
+void check_string_lengths() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  // long defaults are neither copied nor truncated
+  const char *long_def = "a default value which is much longer than any number "
+                         "and longer than sixty four symbols";
+  int name  = ARG_PARSER_ADD_STR(parser, "name", 'n', NULL, false);
+  int names = ARG_PARSER_ADD_STR_LIST(parser, "names", 0, NULL, false);
+  int path  = ARG_PARSER_ADD_STRD(parser, "path", 0, NULL, long_def);
+  int num   = ARG_PARSER_ADD_INT(parser, "num", 0, NULL, false);
+
+  const char *usage = arg_parser_usage_cached(parser);
+  assert(strstr(usage, long_def));
+
+  char *str = val_to_string(arg_union_make_from_str(long_def), ArgString);
+  assert(strcmp(str, long_def) == 0);
+  free(str);
+
+  int    argc   = 7;
+  char * args[] = {"program",
+                   "--name",
+                   "first",
+                   "-n=",
+                   "--names=ab,,abcd",
+                   "--num",
+                   "1"};
+  char **argv   = args;
+  int    result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+
+  const char *val = NULL;
+  size_t      len = 0;
+  assert(arg_parser_hget_strn(parser, name, 0, &val, &len) == 1);
+  assert(val == args[2] && len == 5);
+  assert(arg_parser_hget_strn(parser, name, 1, &val, &len) == 1);
+  assert(len == 0 && *val == '\0');
+  assert(arg_parser_hget_strn(parser, name, 2, &val, &len) == 0);
+  assert(ARG_PARSER_GET_STRN(parser, "name", val, len) == 1 && len == 5);
+
+  // values of string lists are parts of a copy split at separators, so every
+  // value is terminated by `\0` and its length is known without strlen
+  size_t lens[] = {2, 0, 4};
+  for (unsigned i = 0; i < 3; ++i) {
+    assert(arg_parser_hget_strn(parser, names, i, &val, &len) == 1);
+    assert(len == lens[i] && strlen(val) == len);
+  }
+  assert(strncmp(val, "abcd", len) == 0);
+
+  assert(arg_parser_hget_strn(parser, path, 0, &val, &len) == 1);
+  assert(val == long_def && len == strlen(long_def));
+  assert(arg_parser_hget_strn(parser, num, 0, &val, &len) == -1);
+
+  // lengths are kept for values from file
+  char        file[] = "/tmp/arg_parser_lengths_XXXXXX";
+  const char *config = "name = \"hello world\"\n";
+  write_file(file, config, strlen(config));
+  assert(arg_parser_load_file(parser, file, NULL) == 0);
+  argc   = 1;
+  argv   = args;
+  result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+  assert(ARG_PARSER_HGET_STRN(parser, name, val, len) == 1);
+  assert(len == 11 && strncmp(val, "hello world", len) == 0);
+  unlink(file);
+
+  arg_result *res = arg_result_make();
+  argc            = 3;
+  argv            = args;
+  result = arg_parser_parse_into(parser, res, &argc, &argv, false, false, NULL);
+  assert(result == 0);
+  assert(ARG_RESULT_HGET_STRN(parser, res, name, val, len) == 1 && len == 5);
+  arg_result_dispose(res);
+
+  arg_parser_dispose(parser);
+}
+
+void check_bound_vars() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  int h_threads = ARG_PARSER_ADD_INTD(parser, "threads", 't', NULL, 4);
+  int h_path    = ARG_PARSER_ADD_STR(parser, "path", 'p', NULL, false);
+  int h_ratio   = ARG_PARSER_ADD_DOUBLE(parser, "ratio", 0, NULL, false);
+  int h_ids     = ARG_PARSER_ADD_INT_LIST(parser, "ids", 0, NULL, false);
+
+  int         threads = 1;
+  const char *path    = NULL;
+  double      ratio   = 0.5;
+  assert(arg_parser_bind(parser, h_threads, &threads) == 0);
+  assert(arg_parser_bind(parser, h_path, &path) == 0);
+  assert(arg_parser_bind(parser, h_ratio, &ratio) == 0);
+  assert(arg_parser_bind(parser, h_ids, &threads) == -1);
+  assert(arg_parser_bind(parser, 100, &threads) == -1);
+  assert(arg_parser_bind(parser, h_ratio, NULL) == -1);
+  assert(arg_parser_add_bound(parser,
+                              "unbound",
+                              0,
+                              NULL,
+                              ArgInt,
+                              0,
+                              arg_union_make_from_int(0),
+                              NULL) == -1);
+  assert(arg_parser_handle(parser, "unbound") < 0);
+
+  int    argc   = 4;
+  char * args[] = {"program", "-p", "first", "--path=second"};
+  char **argv   = args;
+  int    result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+  assert(threads == 4 && "default is written");
+  assert(strcmp(path, "second") == 0 && "last value is written");
+  assert(ratio == 0.5 && "variable without value isn't changed");
+
+  // other results are written only by request
+  arg_result *res = arg_result_make();
+  argc            = 3;
+  argv            = args;
+  result = arg_parser_parse_into(parser, res, &argc, &argv, false, false, NULL);
+  assert(result == 0 && strcmp(path, "second") == 0);
+  arg_result_write_bound(parser, res);
+  assert(strcmp(path, "first") == 0);
+  arg_result_dispose(res);
+
+  arg_parser_dispose(parser);
+}
+
+struct daemon_config {
+  const char *host;
+  int         port;
+  long        backlog;
+  long long   limit;
+  double      timeout;
+  bool        verbose;
+  bool        daemonize;
+};
+
+void check_bind_macros() {
+  arg_parser *parser = arg_parser_make(NULL);
+
+  struct daemon_config cfg = {NULL, 0, 16, 0, 0, false, false};
+  ARG_PARSER_BIND_STRD(parser, "host", 'H', NULL, "localhost", &cfg.host);
+  ARG_PARSER_BIND_INT(parser, "port", 'p', "port to listen", &cfg.port);
+  ARG_PARSER_BIND_LONG(parser, "backlog", 0, NULL, &cfg.backlog);
+  ARG_PARSER_BIND_LLD(parser, "limit", 0, NULL, 1LL << 40, &cfg.limit);
+  ARG_PARSER_BIND_DOUBLED(parser, "timeout", 't', NULL, 1.5, &cfg.timeout);
+  ARG_PARSER_BIND_BOOL(parser, "verbose", 'v', NULL, &cfg.verbose);
+  int daemonize =
+      ARG_PARSER_BIND_BOOLD(parser, "daemonize", 'd', NULL, 1, &cfg.daemonize);
+
+  const char *usage = arg_parser_usage_cached(parser);
+  assert(strstr(usage, "--host (=localhost)"));
+
+  int    argc   = 5;
+  char * args[] = {"program", "-p", "8080", "-v", "--daemonize=false"};
+  char **argv   = args;
+  int    result = ARG_PARSER_PARSE(parser, argc, argv, false, false, NULL);
+  assert(result == 0);
+
+  assert(strcmp(cfg.host, "localhost") == 0);
+  assert(cfg.port == 8080);
+  assert(cfg.backlog == 16 && "variable without value isn't changed");
+  assert(cfg.limit == 1LL << 40);
+  assert(cfg.timeout == 1.5);
+  assert(cfg.verbose == true && cfg.daemonize == false);
+
+  // bound args are still usual args
+  bool val = true;
+  assert(ARG_PARSER_HGET_BOOL(parser, daemonize, val) == 1 && val == false);
+
+  arg_parser_dispose(parser);
+}
+
 int main() {
   check_arg_parser_create_and_dispose_only_with_desc(NULL);
   check_arg_parser_create_and_dispose_only_with_desc("");
@@ -321,5 +1852,28 @@ int main() {
 
   check_positional_args();
 
+  check_many_flags();
+  check_handles();
+  check_static_args();
+  check_response_files();
+  check_feed();
+  check_reset();
+  check_reset_reuses_memory();
+  check_results();
+  check_parse_many();
+  check_numbers();
+  check_kept_args();
+  check_usage_writer();
+  check_env();
+  check_config_file();
+  check_subcommands();
+  check_completion();
+  check_abbrev_and_suggestions();
+  check_short_clusters();
+  check_list_args();
+  check_string_lengths();
+  check_bound_vars();
+  check_bind_macros();
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,231 @@
+#include "arg_parser.hpp"
+#include <cassert>
+#include <cstring>
+
+
+static constexpr auto cli =
+    arg::make_schema(arg::spec<bool>("help", 'h', "print usage info"),
+                     arg::spec<const char *>("Config_Path", 'c').required(),
+                     arg::spec<int>("threads", 't').def(4),
+                     arg::spec<long>("some_long", 0),
+                     arg::spec<long long>("some_ll", 0).def(10),
+                     arg::spec<double>("ratio", 'r').def(0.5),
+                     arg::spec<int>("level", 'l'));
+
+static_assert(cli.find("config-path") == 1, "names are normalized");
+static_assert(cli.find("CONFIG_PATH") == 1, "names are normalized");
+static_assert(cli.find("unknown") == -1, "unknown flag");
+static_assert(cli.find_short('t') == 2, "short names are indexed");
+
+
+void check_static_schema_index() {
+  for (std::size_t i = 0; i < cli.size; ++i) {
+    assert(cli.find(cli.entries[i].name) == static_cast<int>(i));
+  }
+
+  static constexpr auto empty = arg::make_schema();
+  static_assert(empty.find("help") == -1, "empty schema");
+}
+
+void check_static_parser() {
+  arg::static_parser<cli> parser;
+
+  // clang-format off
+  char *args[] = {(char *)"program",
+                  (char *)"--config-path", (char *)"path",
+                  (char *)"-t=8",
+                  (char *)"pos",
+                  (char *)"--SOME_LONG", (char *)"2",
+                  (char *)"-l", (char *)"1",
+                  (char *)"--level=3",
+                  (char *)"-h"};
+  // clang-format on
+  int result = parser.parse(11, args);
+  assert(result == 0);
+
+  assert(parser.get<cli.index("help")>() == true);
+  assert(std::strcmp(parser.get<cli.index("config_path")>(), "path") == 0);
+  assert(parser.get<cli.index("threads")>() == 8);
+  assert(parser.get<cli.index("some-long")>() == 2);
+  assert(parser.get<cli.index("some-ll")>() == 10);
+  assert(parser.get<cli.index("ratio")>() > 0.4);
+  assert(parser.count<cli.index("level")>() == 2);
+  assert(parser.get<cli.index("level")>() == 3);
+
+  // clusters of short flags and attached values as for arg_parser_parse
+  char *cluster[] = {(char *)"program",
+                     (char *)"-hcpath",
+                     (char *)"-t16",
+                     (char *)"-hl=5"};
+  assert(parser.parse(4, cluster) == 0);
+  assert(parser.count<cli.index("help")>() == 2);
+  assert(parser.view<cli.index("config_path")>() == "path");
+  assert(parser.get<cli.index("threads")>() == 16);
+  assert(parser.get<cli.index("level")>() == 5);
+
+  char *unknown[] = {(char *)"program", (char *)"-c=path", (char *)"-hx"};
+  assert(parser.parse(3, unknown) == 2 && parser.error_flag() == "-hx");
+  assert(parser.count<cli.index("help")>() == 0);
+}
+
+void check_static_parser_errors() {
+  arg::static_parser<cli> parser;
+
+  char *no_required[] = {(char *)"program", (char *)"-t", (char *)"1"};
+  assert(parser.parse(3, no_required) == 3);
+  assert(parser.error_flag() == "Config_Path");
+
+  char *unknown[] = {(char *)"program", (char *)"-c=path", (char *)"--unknown"};
+  assert(parser.parse(3, unknown) == 2);
+  assert(parser.parse(3, unknown, true) == 0);
+
+  char *no_value[] = {(char *)"program", (char *)"-c"};
+  assert(parser.parse(2, no_value) == 1);
+
+  char *bad_value[] = {(char *)"program", (char *)"-c=path", (char *)"-t=x"};
+  assert(parser.parse(3, bad_value) == 4);
+  assert(parser.error_flag() == "-t=x");
+}
+
+void check_string_views() {
+  arg::static_parser<cli> parser;
+
+  char *args[] = {(char *)"program", (char *)"-c=some path"};
+  assert(parser.parse(2, args) == 0);
+  assert(parser.view<cli.index("config-path")>() == "some path");
+  assert(parser.view<cli.index("config-path")>().data() == args[1] + 3);
+
+  arg_parser *dyn   = arg_parser_make(nullptr);
+  int         name  = ARG_PARSER_ADD_STR(dyn, "name", 0, nullptr, false);
+  int         names = ARG_PARSER_ADD_STR_LIST(dyn, "names", 0, nullptr, false);
+  int         num   = ARG_PARSER_ADD_INT(dyn, "num", 0, nullptr, false);
+
+  int    argc       = 4;
+  char * dyn_args[] = {(char *)"program",
+                       (char *)"--name=first",
+                       (char *)"--names=a,bc",
+                       (char *)"--num=1"};
+  char **argv       = dyn_args;
+  int    result = ARG_PARSER_PARSE(dyn, argc, argv, false, false, nullptr);
+  assert(result == 0);
+
+  assert(arg::hget_view(dyn, name) == "first");
+  assert(arg::hget_view(dyn, names, 0) == "a");
+  assert(arg::hget_view(dyn, names, 1) == "bc");
+  assert(arg::hget_view(dyn, names, 2).empty());
+  assert(arg::hget_view(dyn, num).empty());
+  arg_parser_dispose(dyn);
+}
+
+void check_parser_wrapper() {
+  arg::parser parser("description");
+
+  auto help    = parser.add(arg::spec<bool>("help", 'h'));
+  auto threads = parser.add(arg::spec<int>("threads", 't').def(4));
+  auto name    = parser.add(arg::spec<const char *>("name", 'n').required());
+  auto level   = parser.add(arg::spec<long>("level", 'l'));
+  auto ratio   = parser.add(arg::spec<double>("ratio", 0));
+  auto ids     = parser.add_list(arg::spec<int>("ids", 'i'), "1,2");
+  auto names   = parser.add_list(arg::spec<const char *>("names", 0));
+
+  assert(parser.usage().find("--ids (=1,2)") != std::string_view::npos);
+
+  // clang-format off
+  char *args[] = {(char *)"program",
+                  (char *)"--name", (char *)"first",
+                  (char *)"-l=1",
+                  (char *)"-l=2",
+                  (char *)"-i=3,4,5",
+                  (char *)"--names=a,bc"};
+  // clang-format on
+  assert(parser.parse(7, args) == 0);
+  assert(parser.error().empty());
+
+  assert(help.get() == std::nullopt);
+  assert(threads.get() == 4);
+  assert(name.view() == "first");
+  assert(level.count() == 2 && level.get() == 2L);
+  assert(level.values()[0] == 1);
+  assert(ratio.value_or(0.5) == 0.5);
+
+  // values are read from storage of parser without copying
+  arg::span<int> id_vals = ids.values();
+  assert(id_vals.size() == 3 && id_vals[0] == 3 && id_vals[2] == 5);
+  unsigned len = 0;
+  assert(id_vals.data() ==
+         ARG_PARSER_HGET_INT_LIST(parser.get(), ids.handle(), len));
+  assert(names.count() == 2 && names.view(1) == "bc");
+
+  // handles stay valid after moving of the parser
+  arg::parser moved = std::move(parser);
+  assert(parser.get() == nullptr);
+  char *defaults[] = {(char *)"program", (char *)"-h", (char *)"-n=x"};
+  assert(moved.parse(3, defaults) == 0);
+  assert(help.get() == true);
+  assert(ids.values().size() == 2 && ids.get() == 2);
+
+  char *no_required[] = {(char *)"program"};
+  assert(moved.parse(1, no_required) == 3);
+  assert(moved.error().find("name") != std::string_view::npos);
+
+  arg::flag<int> empty;
+  assert(empty.get() == std::nullopt && empty.values().empty());
+}
+
+struct config {
+  int         threads = 1;
+  long        level   = 0;
+  const char *path    = nullptr;
+  bool        verbose = false;
+  double      ratio   = 0.5;
+};
+
+static constexpr auto config_fields = std::make_tuple(
+    arg::make_field(&config::threads, arg::spec<int>("threads", 't').def(4)),
+    arg::make_field(&config::level, arg::spec<long>("level", 'l')),
+    arg::make_field(&config::path, arg::spec<const char *>("path", 'p')),
+    arg::make_field(&config::verbose, arg::spec<bool>("verbose", 'v')),
+    arg::make_field(&config::ratio, arg::spec<double>("ratio", 0)));
+
+void check_struct_binding() {
+  config      cfg;
+  arg::parser parser;
+  parser.bind(cfg, config_fields);
+
+  int  extra     = 0;
+  auto extra_flg = parser.bind(&extra, arg::spec<int>("extra", 'e'));
+
+  char *args[] = {(char *)"program",
+                  (char *)"-l=1",
+                  (char *)"-l=2",
+                  (char *)"--path=some",
+                  (char *)"-v",
+                  (char *)"-e=3"};
+  assert(parser.parse(6, args) == 0);
+  assert(cfg.threads == 4 && "default is written");
+  assert(cfg.level == 2 && "last value is written");
+  assert(std::strcmp(cfg.path, "some") == 0);
+  assert(cfg.verbose == true);
+  assert(cfg.ratio == 0.5 && "member without value isn't changed");
+  assert(extra == 3 && extra_flg.get() == 3);
+
+  int *none = nullptr;
+  assert(parser.bind(none, arg::spec<int>("none", 0)).handle() == -1);
+
+  // members aren't written if parsing failed
+  cfg.level        = 0;
+  char *bad_args[] = {(char *)"program", (char *)"-l=2", (char *)"-t=x"};
+  assert(parser.parse(3, bad_args) == 4);
+  assert(cfg.level == 0);
+}
+
+int main() {
+  check_static_schema_index();
+  check_static_parser();
+  check_static_parser_errors();
+  check_string_views();
+  check_parser_wrapper();
+  check_struct_binding();
+
+  return EXIT_SUCCESS;
+}